@@ -0,0 +1,431 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * ahwm-bench-core: time AHWM's core algorithms without an X server.
+ * The window placement search, the timer heap, the stacking order,
+ * the focus rings and the matching of configuration contexts are
+ * linked in from their X-free halves (place-core.c, timer.c,
+ * stacking-core.c, focus-core.c and prefs-core.c) and run on made-up
+ * clients at a scale well past what a real session sees.  Each line
+ * of output gives a benchmark, its size and the time per operation,
+ * so an algorithmic regression shows up as a jump in one line.
+ * 
+ * usage: ahwm-bench-core [-s SCALE]
+ * 
+ *   -s  multiply every size by SCALE percent (default 100)
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "client.h"
+#include "workspace.h"
+#include "prefs.h"
+#include "place-core.h"
+#include "stacking-core.h"
+#include "focus-core.h"
+#include "prefs-core.h"
+#include "timer.h"
+#include "malloc.h"
+
+/* the parts of AHWM the cores use, standing in for the real ones */
+unsigned int workspace_current = 1;
+
+static client_t *clients = NULL;
+static int nclients = 0;
+static int scale = 100;
+
+client_t *client_find(Window w)
+{
+    if (w < 1 || w > (Window)nclients) return NULL;
+    return &clients[w - 1];
+}
+
+static long now_usecs();
+static void report(char *name, int n, long ops, long usecs);
+static void make_clients(int n);
+static void bench_place(int n);
+static void bench_timers(int n);
+static void bench_stacking(int n);
+static void bench_transients(int depth);
+static void bench_focus(int n);
+static void bench_prefs(int n, int ncontexts);
+static void timer_nop(timer *t, void *arg);
+
+int main(int argc, char **argv)
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "s:")) != -1) {
+        switch (c) {
+            case 's':
+                scale = atoi(optarg);
+                if (scale > 0) break;
+                /* fall through */
+            default:
+                fprintf(stderr, "usage: %s [-s SCALE]\n", argv[0]);
+                return 2;
+        }
+    }
+    srand(1);
+    timer_init();
+
+    bench_place(10);
+    bench_place(100);
+    bench_place(300);
+    bench_timers(10000);
+    bench_timers(100000);
+    bench_stacking(100);
+    bench_stacking(1000);
+    bench_transients(10);
+    bench_transients(200);
+    bench_focus(100);
+    bench_focus(1000);
+    bench_prefs(1000, 10);
+    bench_prefs(1000, 200);
+    return 0;
+}
+
+static long now_usecs()
+{
+    struct timeval tv;
+
+    timer_now(&tv);
+    return (long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void report(char *name, int n, long ops, long usecs)
+{
+    printf("%-24s %8d %12.3f us/op\n", name, n,
+           ops > 0 ? (double)usecs / ops : 0.0);
+    fflush(stdout);
+}
+
+/*
+ * N clients on workspace 1 of a 1280x1024 screen.  Client i has
+ * window i + 1, which is what client_find() expects.
+ */
+
+static void make_clients(int n)
+{
+    char buf[32];
+    int i;
+
+    for (i = 0; i < nclients; i++) {
+        free(clients[i].class);
+    }
+    free(clients);
+    clients = calloc(n, sizeof(client_t));
+    if (clients == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    nclients = n;
+    for (i = 0; i < n; i++) {
+        clients[i].window = i + 1;
+        clients[i].frame = i + 1;
+        clients[i].name = "client";
+        snprintf(buf, sizeof(buf), "Class%d", i % 50);
+        clients[i].class = strdup(buf);
+        clients[i].instance = "instance";
+        clients[i].workspace = 1;
+        clients[i].state = NormalState;
+        clients[i].stacking_order = -1;
+        clients[i].width = 100 + rand() % 400;
+        clients[i].height = 100 + rand() % 300;
+        clients[i].x = rand() % (1280 - clients[i].width);
+        clients[i].y = rand() % (1024 - clients[i].height);
+        clients[i].focus_policy = SloppyFocus;
+        clients[i].cycle_behaviour = i % 10 == 0 ? SkipCycle : DontRaise;
+    }
+}
+
+static void bench_place(int n)
+{
+    place_rect *rects, window;
+    long t, ops;
+    int i;
+
+    n = n * scale / 100;
+    if (n < 1) n = 1;
+    rects = malloc(n * sizeof(place_rect));
+    if (rects == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    make_clients(n);
+    for (i = 0; i < n; i++) {
+        rects[i].x = clients[i].x;
+        rects[i].y = clients[i].y;
+        rects[i].width = clients[i].width;
+        rects[i].height = clients[i].height;
+    }
+    t = now_usecs();
+    for (ops = 0; ops == 0 || now_usecs() - t < 200000; ops++) {
+        window.x = window.y = 0;
+        window.width = 300;
+        window.height = 200;
+        place_least_overlap(rects, n, &window, 1280, 1024);
+    }
+    report("place_least_overlap", n, ops, now_usecs() - t);
+    free(rects);
+}
+
+static void timer_nop(timer *t, void *arg)
+{
+}
+
+static void bench_timers(int n)
+{
+    timer **timers;
+    long t;
+    int i, j;
+
+    n = n * scale / 100;
+    if (n < 1) n = 1;
+    timers = malloc(n * sizeof(timer *));
+    if (timers == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        timers[i] = timer_new(1000 + rand() % 1000000, timer_nop, NULL);
+    }
+    report("timer_new", n, n, now_usecs() - t);
+
+    t = now_usecs();
+    for (j = 0; j < 10; j++) {
+        for (i = 0; i < n; i++) {
+            timer_rearm(timers[i], 1000 + rand() % 1000000);
+        }
+    }
+    report("timer_rearm", n, 10L * n, now_usecs() - t);
+
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        timer_cancel(timers[i]);
+    }
+    report("timer_cancel", n, n, now_usecs() - t);
+
+    /* all due at once, so one timer_run() shoots every one */
+    for (i = 0; i < n; i++) {
+        timers[i] = timer_new(0, timer_nop, NULL);
+    }
+    t = now_usecs();
+    timer_run();
+    report("timer_run", n, n, now_usecs() - t);
+    for (i = 0; i < n; i++) {
+        timer_cancel(timers[i]);
+    }
+    free(timers);
+}
+
+static void bench_stacking(int n)
+{
+    stack s;
+    long t;
+    int i, nbottom = 0;
+
+    n = n * scale / 100;
+    if (n < 1) n = 1;
+    make_clients(n);
+    for (i = 0; i < n; i++) {
+        clients[i].always_on_top = i % 20 == 1;
+        clients[i].always_on_bottom = i % 20 == 2;
+        nbottom += clients[i].always_on_bottom;
+    }
+    memset(&s, 0, sizeof(s));
+
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        stack_add(&s, &clients[i]);
+    }
+    report("stack_add", n, n, now_usecs() - t);
+
+    /* the bottom-most one which can go to the top is the worst case */
+    t = now_usecs();
+    for (i = 0; i < 10 * n; i++) {
+        stack_raise_tree(&s, s.clients[nbottom], NULL);
+    }
+    report("stack_raise_tree", n, 10L * n, now_usecs() - t);
+
+    t = now_usecs();
+    for (i = 0; i < 10 * n; i++) {
+        stack_restack(&s, s.clients[rand() % n], False);
+    }
+    report("stack_restack", n, 10L * n, now_usecs() - t);
+
+    t = now_usecs();
+    while (s.nused > 0) {
+        stack_remove(&s, s.clients[0]);
+    }
+    report("stack_remove", n, n, now_usecs() - t);
+    Free(s.clients);
+}
+
+/*
+ * A chain of DEPTH transient windows, each with one more sibling, all
+ * keeping their transients on top; raising the deepest one walks the
+ * whole tree.
+ */
+
+static void bench_transients(int depth)
+{
+    stack s;
+    client_t *leaf;
+    long t;
+    int i, n;
+
+    depth = depth * scale / 100;
+    if (depth < 1) depth = 1;
+    n = 2 * depth;
+    make_clients(n);
+    memset(&s, 0, sizeof(s));
+    for (i = 0; i < n; i++) {
+        clients[i].keep_transients_on_top = 1;
+        if (i >= 2) {
+            /* i is transient for the chain node above it */
+            clients[i].transient_for = clients[(i / 2 - 1) * 2].window;
+            clients[i].next_transient =
+                clients[(i / 2 - 1) * 2].transients;
+            clients[(i / 2 - 1) * 2].transients = &clients[i];
+        }
+        stack_add(&s, &clients[i]);
+    }
+    leaf = &clients[n - 2];
+    t = now_usecs();
+    for (i = 0; i < 1000; i++) {
+        stack_raise_tree(&s, leaf, NULL);
+        stack_raise_tree(&s, &clients[1], NULL);
+    }
+    report("stack_raise_tree deep", depth, 2000, now_usecs() - t);
+    Free(s.clients);
+}
+
+static void bench_focus(int n)
+{
+    focus_node *nodes, *top;
+    long t, ops;
+    int i;
+
+    n = n * scale / 100;
+    if (n < 1) n = 1;
+    make_clients(n);
+    nodes = calloc(n, sizeof(focus_node));
+    if (nodes == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    top = NULL;
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        nodes[i].client = &clients[i];
+        focus_ring_insert(&nodes[i], top);
+        top = &nodes[i];
+    }
+    report("focus_ring_insert", n, n, now_usecs() - t);
+
+    /* focusing a random window moves it to the top */
+    ops = 100000;
+    t = now_usecs();
+    for (i = 0; i < ops; i++) {
+        focus_ring_permute(top, &nodes[rand() % n]);
+        top = top->prev;
+    }
+    report("focus_ring_permute", n, ops, now_usecs() - t);
+
+    /* Alt-Tab, going the whole way round */
+    t = now_usecs();
+    for (i = 0; i < ops; i++) {
+        top = focus_ring_next(top);
+    }
+    report("focus_ring_next", n, ops, now_usecs() - t);
+
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        focus_ring_remove(&nodes[i]);
+    }
+    report("focus_ring_remove", n, n, now_usecs() - t);
+    free(nodes);
+}
+
+/*
+ * NCONTEXTS contexts matching on window class, only the last of which
+ * matches anything, against N clients.
+ */
+
+static void bench_prefs(int n, int ncontexts)
+{
+    context *contexts;
+    type *values;
+    char buf[32];
+    long t, ops, matches = 0;
+    int i, j;
+
+    n = n * scale / 100;
+    if (n < 1) n = 1;
+    make_clients(n);
+    contexts = calloc(ncontexts, sizeof(context));
+    values = calloc(ncontexts, sizeof(type));
+    if (contexts == NULL || values == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    for (j = 0; j < ncontexts; j++) {
+        snprintf(buf, sizeof(buf), "Class%d",
+                 j == ncontexts - 1 ? 0 : 1000 + j);
+        values[j].type_type = STRING;
+        values[j].type_value.stringval = strdup(buf);
+        contexts[j].context_selector = SEL_WINDOWCLASS;
+        if (j % 4 == 1 && j != ncontexts - 1)
+            contexts[j].context_selector |= SEL_TRANSIENTFOR;
+        contexts[j].context_value = &values[j];
+    }
+    ops = 0;
+    t = now_usecs();
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < ncontexts; j++) {
+            matches += prefs_context_applies(&clients[i], &contexts[j]);
+            ops++;
+        }
+    }
+    report("prefs_context_applies", ncontexts, ops, now_usecs() - t);
+    if (matches == 0) fprintf(stderr, "prefs: nothing matched\n");
+    for (j = 0; j < ncontexts; j++) {
+        free(values[j].type_value.stringval);
+    }
+    free(contexts);
+    free(values);
+}
@@ -0,0 +1,761 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * ahwm-bench: measure how a window manager copes with many windows.
+ * For each window count, we start Xvfb and the window manager (see
+ * harness.h), map that many synthetic client windows and time:
+ * 
+ *   map_us        from a window's map request to its being mapped,
+ *                 which for AHWM includes building its frame
+ *   workspace_us  a switch away from the windows' workspace and back
+ *   cycle_us      one Tab of Alt-Tab cycling
+ *   raise_us      a raise request, bottom window first
+ *   move_rate     pointer motions per second the window manager keeps
+ *                 up with while moving a window interactively
+ *   restart_us    from starting a new window manager to its having
+ *                 adopted every window
+ * 
+ * Results go to standard output as JSON, one object per window count.
+ * Times are in microseconds and include a round trip on the window
+ * manager's control socket, which is how we know the work is done.
+ * The window manager runs with the default configuration, in a
+ * temporary HOME.
+ * 
+ * With -c, we count X requests and round trips instead of timing,
+ * using AHWM's "requests" command (see ipc.h and xstats.h), so that
+ * a change which makes AHWM talk to the server more shows up however
+ * fast the machine is.  Only AHWM's event handlers are counted, not
+ * its timers, and the configuration sets RaiseDelay to zero so that
+ * raising happens in the handlers; every scenario is driven by X
+ * events.  The configuration also gets key bindings for switching
+ * workspaces and enough others to make 40, and the scenarios are:
+ * 
+ *   map_window    mapping a window, with 29 others already mapped
+ *   workspace_30  a switch away from 30 windows' workspace and back
+ *   alt_tab_50    Alt down, Tab 50 times through 50 windows, Alt up
+ * 
+ * The counts go to standard output as one JSON object.  Given a
+ * previous one with -b, we exit with status 1 if a request count has
+ * gone up.  Round trips are only estimated (see xstats.h), so a rise
+ * in those is reported but doesn't fail.
+ * 
+ * This is only a partial stand-in for request-count tests: it needs
+ * Xvfb and XTEST, and counts what a live AHWM does rather than
+ * recording its calls through a fake X backend, which AHWM doesn't
+ * have.
+ * 
+ * usage: ahwm-bench [-d DISPLAY] [-w WM] [-g WIDTHxHEIGHT]
+ *                   [-n COUNT,...] [-H HINT,...] [-c] [-b BASELINE]
+ * 
+ *   -d  the display Xvfb should take (default :9)
+ *   -w  the window manager to run (default ahwm)
+ *   -g  the screen size (default 1280x1024)
+ *   -n  window counts to try (default 10,100,500,1000)
+ *   -H  hints to give some of the windows: "transient" makes every
+ *       fifth window transient for the one before it, "shaped" shapes
+ *       every fifth window, "types" makes every fifth window a utility
+ *       window and every fifth a dialog, and "struts" adds a dock
+ *       with a strut along the top of the screen
+ *   -c  count requests rather than time
+ *   -b  the output of an earlier -c run to compare with; implies -c
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#ifdef SHAPE
+#include <X11/extensions/shape.h>
+#endif
+#include <sys/types.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "harness.h"
+
+#define HINT_TRANSIENT (1 << 0)
+#define HINT_SHAPED    (1 << 1)
+#define HINT_TYPES     (1 << 2)
+#define HINT_STRUTS    (1 << 3)
+
+#define MAX_CYCLES     50       /* Alt-Tabs per run */
+#define MAX_RAISES     200      /* raises per run */
+#define SWITCHES       10       /* workspace round trips per run */
+#define MOTIONS        500      /* pointer motions in the move */
+#define MAP_TIMEOUT    5000000  /* usecs to wait for a window */
+#define ADOPT_TIMEOUT  60000000 /* usecs to wait for a restart */
+#define COUNT_BINDINGS 40       /* key bindings when counting */
+#define SETTLE_ROUNDS  10       /* "sync"s to wait for the counts */
+
+/* what -c measures, in the order it's measured */
+#define TALLY_MAP       0
+#define TALLY_WORKSPACE 1
+#define TALLY_CYCLE     2
+#define NTALLIES        3
+
+typedef struct _tally {
+    char *name;
+    unsigned long requests, roundtrips;
+} tally;
+
+static tally tallies[NTALLIES] = {
+    { "map_window" },
+    { "workspace_30" },
+    { "alt_tab_50" },
+};
+
+typedef struct _series {
+    long *samples;
+    int n, size;
+} series;
+
+static Display *ctl;            /* input and control */
+static Display *cli;            /* the synthetic clients */
+static Window root;
+static int hints = 0;
+static unsigned long start_requests, start_roundtrips;
+static Bool started = False;    /* start_requests is good */
+
+static long now_usecs();
+static void series_add(series *s, long usecs);
+static void series_print(char *name, series *s);
+static int compare_longs(const void *a, const void *b);
+static Bool wait_for(Window w, int type, long timeout);
+static Window make_window(int i, Window previous);
+static void make_dock(int width);
+static void run(char *display, char *wm, int width, int height, int n);
+static Bool count(char *display, char *wm, int width, int height);
+static Bool read_totals(unsigned long *requests, unsigned long *roundtrips);
+static Bool settle(unsigned long *requests, unsigned long *roundtrips);
+static void tally_start();
+static void tally_end(int t);
+static int compare_baseline(char *file);
+static Bool parse_hints(char *s);
+static Bool make_home(Bool counting);
+
+int main(int argc, char **argv)
+{
+    char *display = ":9", *wm = "ahwm", *counts = "10,100,500,1000";
+    char *s, *end, *baseline = NULL;
+    int width = 1280, height = 1024, status = 0;
+    Bool first = True, counting = False;
+    long n;
+    int c;
+
+    while ((c = getopt(argc, argv, "d:w:g:n:H:cb:")) != -1) {
+        switch (c) {
+            case 'd': display = optarg; break;
+            case 'w': wm = optarg; break;
+            case 'n': counts = optarg; break;
+            case 'c': counting = True; break;
+            case 'b': baseline = optarg; counting = True; break;
+            case 'g':
+                if (sscanf(optarg, "%dx%d", &width, &height) == 2
+                    && width > 0 && height > 0)
+                    break;
+                fprintf(stderr, "%s: bad geometry %s\n", argv[0], optarg);
+                return 2;
+            case 'H':
+                if (parse_hints(optarg)) break;
+                fprintf(stderr, "%s: bad hints %s\n", argv[0], optarg);
+                return 2;
+            default:
+                fprintf(stderr, "usage: %s [-d DISPLAY] [-w WM] "
+                        "[-g WIDTHxHEIGHT] [-n COUNT,...] [-H HINT,...] "
+                        "[-c] [-b BASELINE]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    /* the window manager must not read the user's configuration */
+    if (!make_home(counting)) return 1;
+
+    if (counting) {
+        if (!count(display, wm, width, height))
+            status = 1;
+        else if (baseline != NULL)
+            status = compare_baseline(baseline);
+    } else {
+        printf("[\n");
+        for (s = counts; *s != '\0'; s = end) {
+            n = strtol(s, &end, 10);
+            if (end == s || n <= 0) {
+                fprintf(stderr, "%s: bad window count %s\n", argv[0], s);
+                break;
+            }
+            if (*end == ',') end++;
+            if (!first) printf(",\n");
+            first = False;
+            run(display, wm, width, height, (int)n);
+            fflush(stdout);
+        }
+        printf("\n]\n");
+    }
+
+    harness_home_remove();
+    return status;
+}
+
+static void run(char *display, char *wm, int width, int height, int n)
+{
+    series map, workspace, cycle, raise;
+    Window *windows, junk;
+    KeyCode alt, tab;
+    char buf[64];
+    FILE *f;
+    unsigned int ws, nws;
+    long t0, t1, move_rate = 0, restart = -1;
+    int i, x, y, timeouts = 0;
+
+    memset(&map, 0, sizeof(map));
+    memset(&workspace, 0, sizeof(workspace));
+    memset(&cycle, 0, sizeof(cycle));
+    memset(&raise, 0, sizeof(raise));
+    harness_errors = 0;
+
+    printf("  {\"windows\": %d, \"wm\": \"%s\"", n, wm);
+    ctl = harness_start(display, width, height, wm);
+    if (ctl == NULL || (cli = XOpenDisplay(NULL)) == NULL) {
+        printf(", \"error\": \"could not start\"}");
+        if (ctl != NULL) harness_stop(ctl);
+        return;
+    }
+    root = DefaultRootWindow(cli);
+    alt = XKeysymToKeycode(ctl, XK_Alt_L);
+    tab = XKeysymToKeycode(ctl, XK_Tab);
+    windows = malloc(n * sizeof(Window));
+    if (windows == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    if (hints & HINT_STRUTS) make_dock(width);
+
+    for (i = 0; i < n; i++) {
+        windows[i] = make_window(i, i > 0 ? windows[i - 1] : None);
+        t0 = now_usecs();
+        XMapWindow(cli, windows[i]);
+        XFlush(cli);
+        if (wait_for(windows[i], MapNotify, MAP_TIMEOUT))
+            series_add(&map, now_usecs() - t0);
+        else
+            timeouts++;
+    }
+    harness_control("workspace", NULL);
+
+    /* "workspace" answers with the current one and how many there are */
+    f = tmpfile();
+    if (f != NULL && harness_control("workspace", f) == 1) {
+        rewind(f);
+        if (fscanf(f, "%u %u", &ws, &nws) == 2 && nws > 1) {
+            for (i = 0; i < SWITCHES; i++) {
+                t0 = now_usecs();
+                snprintf(buf, sizeof(buf), "goto %u", ws % nws + 1);
+                harness_control(buf, NULL);
+                snprintf(buf, sizeof(buf), "goto %u", ws);
+                harness_control(buf, NULL);
+                series_add(&workspace, now_usecs() - t0);
+            }
+        }
+    }
+    if (f != NULL) fclose(f);
+
+    XTestFakeKeyEvent(ctl, alt, True, 0);
+    for (i = 0; i < n && i < MAX_CYCLES; i++) {
+        t0 = now_usecs();
+        XTestFakeKeyEvent(ctl, tab, True, 0);
+        XTestFakeKeyEvent(ctl, tab, False, 0);
+        XSync(ctl, False);
+        harness_control("workspace", NULL);
+        series_add(&cycle, now_usecs() - t0);
+    }
+    XTestFakeKeyEvent(ctl, alt, False, 0);
+    XSync(ctl, False);
+    harness_control("workspace", NULL);
+
+    for (i = 0; i < n && i < MAX_RAISES; i++) {
+        t0 = now_usecs();
+        XRaiseWindow(cli, windows[i]);
+        XFlush(cli);
+        harness_control("workspace", NULL);
+        series_add(&raise, now_usecs() - t0);
+    }
+
+    /* drag the window we raised last, which is on top */
+    XTranslateCoordinates(cli, windows[i - 1], root, 10, 10, &x, &y, &junk);
+    XTestFakeMotionEvent(ctl, -1, x, y, 0);
+    XTestFakeKeyEvent(ctl, alt, True, 0);
+    XTestFakeButtonEvent(ctl, 1, True, 0);
+    XSync(ctl, False);
+    harness_control("workspace", NULL);
+    t0 = now_usecs();
+    for (i = 0; i < MOTIONS; i++) {
+        XTestFakeMotionEvent(ctl, -1, x + i % 100, y + (i / 100) * 20, 0);
+    }
+    XSync(ctl, False);
+    harness_control("workspace", NULL);
+    t1 = now_usecs();
+    if (t1 > t0) move_rate = (long)((double)MOTIONS * 1000000 / (t1 - t0));
+    XTestFakeButtonEvent(ctl, 1, False, 0);
+    XTestFakeKeyEvent(ctl, alt, False, 0);
+    XSync(ctl, False);
+    harness_control("workspace", NULL);
+
+    harness_stop_wm();
+    t0 = now_usecs();
+    if (harness_start_wm(wm)) {
+        while (harness_control("clients", NULL) < n) {
+            if (now_usecs() - t0 > ADOPT_TIMEOUT) break;
+            usleep(1000);
+        }
+        if (now_usecs() - t0 <= ADOPT_TIMEOUT)
+            restart = now_usecs() - t0;
+    }
+
+    printf(",\n   ");
+    series_print("map_us", &map);
+    printf(",\n   ");
+    series_print("workspace_us", &workspace);
+    printf(",\n   ");
+    series_print("cycle_us", &cycle);
+    printf(",\n   ");
+    series_print("raise_us", &raise);
+    printf(",\n   \"move_rate\": %ld, \"restart_us\": %ld,"
+           " \"timeouts\": %d, \"x_errors\": %d}",
+           move_rate, restart, timeouts, harness_errors);
+
+    free(windows);
+    free(map.samples);
+    free(workspace.samples);
+    free(cycle.samples);
+    free(raise.samples);
+    XCloseDisplay(cli);
+    harness_stop(ctl);
+}
+
+/*
+ * The -c run.  Before the counts are read, settle() waits until the
+ * window manager has handled everything the scenario caused, so each
+ * scenario's counts hold all the work it caused and nothing else.
+ */
+
+static Bool count(char *display, char *wm, int width, int height)
+{
+    Window windows[50];
+    KeyCode alt, tab, control, shift, f1, f2;
+    int i;
+    Bool ok = True;
+
+    harness_errors = 0;
+    ctl = harness_start(display, width, height, wm);
+    if (ctl == NULL || (cli = XOpenDisplay(NULL)) == NULL) {
+        fprintf(stderr, "ahwm-bench: could not start %s\n", wm);
+        if (ctl != NULL) harness_stop(ctl);
+        return False;
+    }
+    root = DefaultRootWindow(cli);
+    alt = XKeysymToKeycode(ctl, XK_Alt_L);
+    tab = XKeysymToKeycode(ctl, XK_Tab);
+    control = XKeysymToKeycode(ctl, XK_Control_L);
+    shift = XKeysymToKeycode(ctl, XK_Shift_L);
+    f1 = XKeysymToKeycode(ctl, XK_F1);
+    f2 = XKeysymToKeycode(ctl, XK_F2);
+    if (hints & HINT_STRUTS) make_dock(width);
+
+    for (i = 0; i < 50; i++) {
+        windows[i] = make_window(i, i > 0 ? windows[i - 1] : None);
+        if (i == 29) tally_start();
+        XMapWindow(cli, windows[i]);
+        XFlush(cli);
+        if (!wait_for(windows[i], MapNotify, MAP_TIMEOUT)) {
+            fprintf(stderr, "ahwm-bench: window %d was never mapped\n", i);
+            ok = False;
+            break;
+        }
+        if (i == 29) {
+            tally_end(TALLY_MAP);
+
+            /* the bindings make_home() added */
+            tally_start();
+            XTestFakeKeyEvent(ctl, control, True, 0);
+            XTestFakeKeyEvent(ctl, shift, True, 0);
+            XTestFakeKeyEvent(ctl, f2, True, 0);
+            XTestFakeKeyEvent(ctl, f2, False, 0);
+            XTestFakeKeyEvent(ctl, f1, True, 0);
+            XTestFakeKeyEvent(ctl, f1, False, 0);
+            XTestFakeKeyEvent(ctl, shift, False, 0);
+            XTestFakeKeyEvent(ctl, control, False, 0);
+            tally_end(TALLY_WORKSPACE);
+        }
+    }
+
+    if (ok) {
+        tally_start();
+        XTestFakeKeyEvent(ctl, alt, True, 0);
+        for (i = 0; i < 50; i++) {
+            XTestFakeKeyEvent(ctl, tab, True, 0);
+            XTestFakeKeyEvent(ctl, tab, False, 0);
+        }
+        XTestFakeKeyEvent(ctl, alt, False, 0);
+        tally_end(TALLY_CYCLE);
+    }
+    for (i = 0; i < NTALLIES; i++) {
+        if (tallies[i].requests == 0) {
+            fprintf(stderr, "ahwm-bench: nothing counted for %s; "
+                    "does %s have the requests command?\n",
+                    tallies[i].name, wm);
+            ok = False;
+        }
+    }
+
+    printf("{\"wm\": \"%s\", \"bindings\": %d, \"x_errors\": %d", wm,
+           harness_bindings, harness_errors);
+    for (i = 0; i < NTALLIES; i++) {
+        printf(",\n \"%s\": {\"requests\": %lu, \"roundtrips\": %lu}",
+               tallies[i].name, tallies[i].requests, tallies[i].roundtrips);
+    }
+    printf("}\n");
+    fflush(stdout);
+
+    XCloseDisplay(cli);
+    harness_stop(ctl);
+    return ok;
+}
+
+static Bool read_totals(unsigned long *requests, unsigned long *roundtrips)
+{
+    FILE *f;
+    Bool ok = False;
+
+    f = tmpfile();
+    if (f == NULL) return False;
+    if (harness_control("requests", f) == 1) {
+        rewind(f);
+        ok = fscanf(f, "%lu %lu", requests, roundtrips) == 2;
+    }
+    fclose(f);
+    return ok;
+}
+
+/*
+ * Wait until the window manager has handled every event our requests
+ * caused, and every event its own requests caused in turn, and read
+ * its totals then.  Once both our connections are synced, the events
+ * are on their way to it; its "sync" command makes sure they have
+ * arrived, and it handles all the events it has before it reads
+ * another command.  Handling them may make more, so we go round
+ * until the totals stop moving.
+ */
+
+static Bool settle(unsigned long *requests, unsigned long *roundtrips)
+{
+    unsigned long last_requests, last_roundtrips;
+    int i;
+
+    XSync(cli, False);
+    XSync(ctl, False);
+    if (!read_totals(&last_requests, &last_roundtrips)) return False;
+    for (i = 0; i < SETTLE_ROUNDS; i++) {
+        if (harness_control("sync", NULL) < 0
+            || !read_totals(requests, roundtrips))
+            return False;
+        if (*requests == last_requests && *roundtrips == last_roundtrips)
+            return True;
+        last_requests = *requests;
+        last_roundtrips = *roundtrips;
+    }
+    fprintf(stderr, "ahwm-bench: the window manager never settled\n");
+    return False;
+}
+
+static void tally_start()
+{
+    started = settle(&start_requests, &start_roundtrips);
+}
+
+static void tally_end(int t)
+{
+    unsigned long requests, roundtrips;
+
+    if (!started || !settle(&requests, &roundtrips)) return;
+    tallies[t].requests = requests - start_requests;
+    tallies[t].roundtrips = roundtrips - start_roundtrips;
+    started = False;
+}
+
+/*
+ * Compare the tallies with FILE, the output of an earlier -c run.
+ * Returns the exit status: 1 if a request count went up.  Round
+ * trips are only estimates, so more of them is just a warning.
+ */
+
+static int compare_baseline(char *file)
+{
+    char buf[4096], key[64], *s;
+    unsigned long requests, roundtrips;
+    size_t len;
+    FILE *f;
+    int i, status = 0;
+
+    f = fopen(file, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ahwm-bench: %s: %s\n", file, strerror(errno));
+        return 1;
+    }
+    len = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[len] = '\0';
+    fclose(f);
+
+    for (i = 0; i < NTALLIES; i++) {
+        snprintf(key, sizeof(key), "\"%s\":", tallies[i].name);
+        s = strstr(buf, key);
+        if (s == NULL
+            || sscanf(s + strlen(key),
+                      " {\"requests\": %lu, \"roundtrips\": %lu}",
+                      &requests, &roundtrips) != 2) {
+            fprintf(stderr, "ahwm-bench: %s has no %s\n", file,
+                    tallies[i].name);
+            continue;
+        }
+        if (tallies[i].requests > requests) {
+            fprintf(stderr, "ahwm-bench: %s: %lu requests, was %lu\n",
+                    tallies[i].name, tallies[i].requests, requests);
+            status = 1;
+        }
+        if (tallies[i].roundtrips > roundtrips) {
+            fprintf(stderr, "ahwm-bench: %s: %lu round trips, was %lu "
+                    "(estimated, not failing)\n",
+                    tallies[i].name, tallies[i].roundtrips, roundtrips);
+        }
+    }
+    return status;
+}
+
+static long now_usecs()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void series_add(series *s, long usecs)
+{
+    if (s->n == s->size) {
+        s->size = s->size == 0 ? 64 : s->size * 2;
+        s->samples = realloc(s->samples, s->size * sizeof(long));
+        if (s->samples == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    s->samples[s->n++] = usecs;
+}
+
+static void series_print(char *name, series *s)
+{
+    double total = 0;
+    int i;
+
+    if (s->n == 0) {
+        printf("\"%s\": null", name);
+        return;
+    }
+    qsort(s->samples, s->n, sizeof(long), compare_longs);
+    for (i = 0; i < s->n; i++)
+        total += s->samples[i];
+    printf("\"%s\": {\"n\": %d, \"mean\": %.0f, \"median\": %ld, "
+           "\"p95\": %ld, \"max\": %ld}", name, s->n, total / s->n,
+           s->samples[s->n / 2], s->samples[s->n * 95 / 100],
+           s->samples[s->n - 1]);
+}
+
+static int compare_longs(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Wait for an event of TYPE on W.  Events we aren't waiting for are
+ * thrown away, since we only ever wait for the window we just made.
+ */
+
+static Bool wait_for(Window w, int type, long timeout)
+{
+    struct timeval tv;
+    fd_set fds;
+    XEvent e;
+    long left;
+
+    timeout += now_usecs();
+    for (;;) {
+        while (XPending(cli) > 0) {
+            XNextEvent(cli, &e);
+            if (e.type == type && e.xany.window == w) return True;
+        }
+        left = timeout - now_usecs();
+        if (left <= 0) return False;
+        tv.tv_sec = left / 1000000;
+        tv.tv_usec = left % 1000000;
+        FD_ZERO(&fds);
+        FD_SET(ConnectionNumber(cli), &fds);
+        select(ConnectionNumber(cli) + 1, &fds, NULL, NULL, &tv);
+    }
+}
+
+static Window make_window(int i, Window previous)
+{
+    XSetWindowAttributes xswa;
+    XClassHint class;
+    Atom type;
+    Window w;
+    char name[32];
+#ifdef SHAPE
+    XRectangle rects[2];
+#endif
+
+    xswa.background_pixel = WhitePixel(cli, DefaultScreen(cli));
+    xswa.event_mask = StructureNotifyMask;
+    w = XCreateWindow(cli, root, 0, 0, 200, 150, 0, CopyFromParent,
+                      InputOutput, CopyFromParent,
+                      CWBackPixel | CWEventMask, &xswa);
+    snprintf(name, sizeof(name), "bench %d", i);
+    XStoreName(cli, w, name);
+    class.res_name = "bench";
+    class.res_class = "AHWMBench";
+    XSetClassHint(cli, w, &class);
+
+    if ((hints & HINT_TRANSIENT) && i % 5 == 1)
+        XSetTransientForHint(cli, w, previous);
+#ifdef SHAPE
+    if ((hints & HINT_SHAPED) && i % 5 == 2) {
+        rects[0].x = 0;
+        rects[0].y = 0;
+        rects[0].width = 200;
+        rects[0].height = 75;
+        rects[1].x = 0;
+        rects[1].y = 75;
+        rects[1].width = 100;
+        rects[1].height = 75;
+        XShapeCombineRectangles(cli, w, ShapeBounding, 0, 0, rects, 2,
+                                ShapeSet, YXBanded);
+    }
+#endif
+    if ((hints & HINT_TYPES) && (i % 5 == 3 || i % 5 == 4)) {
+        type = XInternAtom(cli, i % 5 == 3 ? "_NET_WM_WINDOW_TYPE_UTILITY"
+                           : "_NET_WM_WINDOW_TYPE_DIALOG", False);
+        XChangeProperty(cli, w, XInternAtom(cli, "_NET_WM_WINDOW_TYPE", False),
+                        XA_ATOM, 32, PropModeReplace,
+                        (unsigned char *)&type, 1);
+    }
+    return w;
+}
+
+static void make_dock(int width)
+{
+    XSetWindowAttributes xswa;
+    Atom type;
+    long strut[4];
+    Window w;
+
+    xswa.background_pixel = BlackPixel(cli, DefaultScreen(cli));
+    xswa.event_mask = StructureNotifyMask;
+    w = XCreateWindow(cli, root, 0, 0, width, 24, 0, CopyFromParent,
+                      InputOutput, CopyFromParent,
+                      CWBackPixel | CWEventMask, &xswa);
+    type = XInternAtom(cli, "_NET_WM_WINDOW_TYPE_DOCK", False);
+    XChangeProperty(cli, w, XInternAtom(cli, "_NET_WM_WINDOW_TYPE", False),
+                    XA_ATOM, 32, PropModeReplace, (unsigned char *)&type, 1);
+    strut[0] = 0;               /* left, right, top, bottom */
+    strut[1] = 0;
+    strut[2] = 24;
+    strut[3] = 0;
+    XChangeProperty(cli, w, XInternAtom(cli, "_NET_WM_STRUT", False),
+                    XA_CARDINAL, 32, PropModeReplace,
+                    (unsigned char *)strut, 4);
+    XMapWindow(cli, w);
+    XFlush(cli);
+    wait_for(w, MapNotify, MAP_TIMEOUT);
+}
+
+static Bool parse_hints(char *s)
+{
+    char *word;
+
+    for (word = strtok(s, ","); word != NULL; word = strtok(NULL, ",")) {
+        if (strcmp(word, "transient") == 0) {
+            hints |= HINT_TRANSIENT;
+        } else if (strcmp(word, "shaped") == 0) {
+            hints |= HINT_SHAPED;
+        } else if (strcmp(word, "types") == 0) {
+            hints |= HINT_TYPES;
+        } else if (strcmp(word, "struts") == 0) {
+            hints |= HINT_STRUTS;
+        } else {
+            return False;
+        }
+    }
+    return True;
+}
+
+/*
+ * A temporary HOME holding the default configuration (see
+ * harness_home()).  When COUNTING, we also add the bindings count()
+ * uses and others until there are COUNT_BINDINGS, and turn off
+ * RaiseDelay.
+ */
+
+static Bool make_home(Bool counting)
+{
+    FILE *f;
+    int i;
+
+    f = harness_home(counting);
+    if (f == NULL) return False;
+    if (counting) {
+        /* raise in the handler, not from a timer */
+        fprintf(f, "RaiseDelay = 0;\n");
+        fprintf(f, "BindKey \"Control | Shift | F1\" GotoWorkspace(1);\n");
+        fprintf(f, "BindKey \"Control | Shift | F2\" GotoWorkspace(2);\n");
+        harness_bindings += 2;
+        for (i = 2; harness_bindings < COUNT_BINDINGS && i < 24; i++) {
+            fprintf(f, "BindKey \"Control | %sShift | F%d\" "
+                    "Launch(\"true\");\n", i < 12 ? "" : "Alt | ",
+                    i % 12 + 1);
+            harness_bindings++;
+        }
+    }
+    fclose(f);
+    return True;
+}
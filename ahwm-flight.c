@@ -0,0 +1,138 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * ahwm-flight: print a flight recorder dump (see flight.h), oldest
+ * record first.  Times are in seconds before the last record, which
+ * after a crash is about when AHWM died.
+ * 
+ * usage: ahwm-flight [FILE]
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "flight.h"
+#include "xev.h"
+
+static void print_record(flight_record *r, flight_record *last)
+{
+    const char *name;
+    long usecs;
+
+    usecs = ((long)last->sec - (long)r->sec) * 1000000
+        + (long)last->usec - (long)r->usec;
+    printf("-%ld.%06ld  ", usecs / 1000000, usecs % 1000000);
+    switch (r->kind) {
+        case FLIGHT_EVENT:
+            name = xev_name(r->detail);
+            if (name != NULL)
+                printf("event   %-17s 0x%08lx %8luus\n", name,
+                       (unsigned long)r->window, (unsigned long)r->arg);
+            else
+                printf("event   %-17d 0x%08lx %8luus\n", r->detail,
+                       (unsigned long)r->window, (unsigned long)r->arg);
+            break;
+        case FLIGHT_FOCUS:
+            printf("focus   0x%08lx time %lu\n",
+                   (unsigned long)r->window, (unsigned long)r->arg);
+            break;
+        case FLIGHT_RAISE:
+            printf("raise   0x%08lx depth %lu\n",
+                   (unsigned long)r->window, (unsigned long)r->arg);
+            break;
+        case FLIGHT_RESTACK:
+            printf("restack 0x%08lx depth %lu\n",
+                   (unsigned long)r->window, (unsigned long)r->arg);
+            break;
+        default:
+            printf("kind %d detail %d 0x%08lx %lu\n", r->kind, r->detail,
+                   (unsigned long)r->window, (unsigned long)r->arg);
+            break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    char buf[1024], *file, *home;
+    flight_header h;
+    flight_record *ring;
+    FILE *f;
+    unsigned long i, n, start;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [FILE]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2) {
+        file = argv[1];
+    } else if ((file = getenv("AHWM_FLIGHT")) == NULL || *file == '\0') {
+        home = getenv("HOME");
+        snprintf(buf, sizeof(buf), "%s/.ahwm-flight",
+                 home != NULL ? home : "");
+        file = buf;
+    }
+
+    f = fopen(file, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], file, strerror(errno));
+        return 1;
+    }
+    if (fread(&h, sizeof(h), 1, f) != 1
+        || h.magic != FLIGHT_MAGIC || h.version != FLIGHT_VERSION
+        || h.record_size != sizeof(flight_record) || h.nrecords == 0) {
+        fprintf(stderr, "%s: %s is not a flight recorder dump\n",
+                argv[0], file);
+        return 1;
+    }
+    ring = malloc(h.nrecords * sizeof(flight_record));
+    if (ring == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    if (fread(ring, sizeof(flight_record), h.nrecords, f) != h.nrecords) {
+        fprintf(stderr, "%s: %s is truncated\n", argv[0], file);
+        return 1;
+    }
+    fclose(f);
+
+    if (h.total < h.nrecords) {
+        n = h.total;
+        start = 0;
+    } else {
+        n = h.nrecords;
+        start = h.total % h.nrecords;
+    }
+    if (n == 0) return 0;
+    for (i = 0; i < n; i++) {
+        print_record(&ring[(start + i) % h.nrecords],
+                     &ring[(start + n - 1) % h.nrecords]);
+    }
+    return 0;
+}
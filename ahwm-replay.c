@@ -0,0 +1,458 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * ahwm-replay: replay a session recorded with AHWM_RECORD (see
+ * record.h) against a window manager running on a private Xvfb, and
+ * report how long it took.  Recorded windows are played by stand-in
+ * windows carrying the recorded properties, and input is faked with
+ * the XTEST extension.  After every event we wait until the window
+ * manager answers a command on its control socket, so the time is
+ * roughly the time it took to handle the whole session.
+ * 
+ * The window manager runs with the default configuration in a
+ * temporary HOME, with RoundTripBudget set, so the results don't
+ * depend on the user's configuration and the "stats" at the end
+ * include its request counts (see xstats.h).
+ * 
+ * usage: ahwm-replay [-d DISPLAY] [-w WM] [-r] FILE
+ * 
+ *   -d  the display Xvfb should take (default :9)
+ *   -w  the window manager to run (default ahwm)
+ *   -r  replay in real time, rather than as fast as possible
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xmd.h>
+#include <X11/extensions/XTest.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "harness.h"
+#include "record.h"
+#include "xev.h"
+
+typedef struct _id_map {
+    unsigned long from, to;
+} id_map;
+
+static Display *ctl;            /* input, client messages */
+static Display *cli;            /* the stand-in windows */
+static Window root;
+static unsigned long counts[LASTEvent];
+static unsigned long skipped = 0;
+
+static id_map *windows = NULL, *atoms = NULL;
+static int nwindows = 0, natoms = 0;
+static Window pending_map = None;
+static unsigned int modifiers = 0; /* the ones we've faked down */
+static XModifierKeymap *modmap;
+
+static unsigned long map_find(id_map *map, int n, unsigned long from);
+static void map_add(id_map **map, int *n, unsigned long from,
+                    unsigned long to);
+static void map_remove(id_map *map, int *n, unsigned long from);
+static Window window_for(CARD32 w);
+static Atom atom_for(CARD32 a);
+static void set_modifiers(unsigned int state);
+static void replay_window(recorded_window *rw);
+static void withdraw(Window w);
+static void replay_property(recorded_property *rp, unsigned char *data);
+static void replay_event(recorded_event *re);
+
+int main(int argc, char **argv)
+{
+    char *display = ":9", *wm = "ahwm", *file;
+    record_file_header fh;
+    record_header h;
+    unsigned char *buf = NULL;
+    unsigned long size = 0;
+    struct timeval start, end, now, first;
+    Bool realtime = False, have_first = False;
+    long usecs, due;
+    FILE *f, *rc;
+    int c, i;
+
+    while ((c = getopt(argc, argv, "d:w:r")) != -1) {
+        switch (c) {
+            case 'd': display = optarg; break;
+            case 'w': wm = optarg; break;
+            case 'r': realtime = True; break;
+            default:
+                fprintf(stderr, "usage: %s [-d DISPLAY] [-w WM] [-r] FILE\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-d DISPLAY] [-w WM] [-r] FILE\n",
+                argv[0]);
+        return 2;
+    }
+    file = argv[optind];
+
+    f = fopen(file, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], file, strerror(errno));
+        return 1;
+    }
+    if (fread(&fh, sizeof(fh), 1, f) != 1 || fh.magic != RECORD_MAGIC
+        || fh.version != RECORD_VERSION) {
+        fprintf(stderr, "%s: %s is not an AHWM recording\n", argv[0], file);
+        return 1;
+    }
+
+    rc = harness_home(True);
+    if (rc == NULL) return 1;
+    fclose(rc);
+    ctl = harness_start(display, fh.width, fh.height, wm);
+    if (ctl == NULL) {
+        harness_home_remove();
+        return 1;
+    }
+    cli = XOpenDisplay(NULL);
+    if (cli == NULL || !XTestQueryExtension(ctl, &i, &i, &i, &i)) {
+        fprintf(stderr, "%s: %s has no XTEST extension\n", argv[0], display);
+        harness_stop(ctl);
+        harness_home_remove();
+        return 1;
+    }
+    root = DefaultRootWindow(ctl);
+    map_add(&windows, &nwindows, fh.root, root);
+    modmap = XGetModifierMapping(ctl);
+
+    gettimeofday(&start, NULL);
+    while (fread(&h, sizeof(h), 1, f) == 1) {
+        if (h.length > size) {
+            size = h.length;
+            buf = realloc(buf, size);
+            if (buf == NULL) {
+                perror("realloc");
+                return 1;
+            }
+        }
+        if (h.length > 0 && fread(buf, h.length, 1, f) != 1) {
+            fprintf(stderr, "%s: %s is truncated\n", argv[0], file);
+            break;
+        }
+        if (pending_map != None && h.kind != RECORD_PROPERTY
+            && h.kind != RECORD_ATOM) {
+            XMapWindow(cli, pending_map);
+            pending_map = None;
+        }
+        switch (h.kind) {
+            case RECORD_ATOM:
+                if (h.length > sizeof(CARD32)) {
+                    buf[h.length - 1] = '\0';
+                    map_add(&atoms, &natoms, *(CARD32 *)buf,
+                            XInternAtom(cli, (char *)buf + sizeof(CARD32),
+                                        False));
+                }
+                break;
+            case RECORD_WINDOW:
+                replay_window((recorded_window *)buf);
+                break;
+            case RECORD_PROPERTY:
+                replay_property((recorded_property *)buf,
+                                buf + sizeof(recorded_property));
+                break;
+            case RECORD_EVENT:
+                if (realtime) {
+                    if (!have_first) {
+                        /* 'first' is wall time minus recorded time */
+                        gettimeofday(&first, NULL);
+                        first.tv_sec -= h.sec;
+                        first.tv_usec -= h.usec;
+                        have_first = True;
+                    }
+                    gettimeofday(&now, NULL);
+                    due = ((long)h.sec + first.tv_sec - now.tv_sec)
+                        * 1000000
+                        + (long)h.usec + first.tv_usec - now.tv_usec;
+                    if (due > 0) usleep(due);
+                }
+                replay_event((recorded_event *)buf);
+                XSync(cli, False);
+                XSync(ctl, False);
+                if (harness_control("workspace", NULL) < 0) goto done;
+                break;
+        }
+    }
+done:
+    gettimeofday(&end, NULL);
+    fclose(f);
+
+    usecs = (end.tv_sec - start.tv_sec) * 1000000
+        + end.tv_usec - start.tv_usec;
+    printf("replayed %s in %ld.%06lds\n", file,
+           usecs / 1000000, usecs % 1000000);
+    for (i = 0; i < LASTEvent; i++) {
+        if (counts[i] > 0)
+            printf("  %-17s %8lu\n", xev_name(i), counts[i]);
+    }
+    printf("  %-17s %8lu\n", "(not replayed)", skipped);
+    printf("  %-17s %8d\n", "(X errors)", harness_errors);
+    harness_control("stats", stdout);
+
+    set_modifiers(0);
+    XCloseDisplay(cli);
+    harness_stop(ctl);
+    harness_home_remove();
+    return 0;
+}
+
+static unsigned long map_find(id_map *map, int n, unsigned long from)
+{
+    int i;
+
+    for (i = n - 1; i >= 0; i--) {
+        if (map[i].from == from) return map[i].to;
+    }
+    return 0;
+}
+
+static void map_add(id_map **map, int *n, unsigned long from,
+                    unsigned long to)
+{
+    *map = realloc(*map, (*n + 1) * sizeof(id_map));
+    if (*map == NULL) {
+        perror("realloc");
+        exit(1);
+    }
+    (*map)[*n].from = from;
+    (*map)[*n].to = to;
+    (*n)++;
+}
+
+static void map_remove(id_map *map, int *n, unsigned long from)
+{
+    int i;
+
+    for (i = 0; i < *n; i++) {
+        if (map[i].from == from) {
+            map[i] = map[*n - 1];
+            (*n)--;
+            return;
+        }
+    }
+}
+
+static Window window_for(CARD32 w)
+{
+    return map_find(windows, nwindows, w);
+}
+
+/* predefined atoms are the same on every server */
+static Atom atom_for(CARD32 a)
+{
+    if (a <= XA_LAST_PREDEFINED) return a;
+    return map_find(atoms, natoms, a);
+}
+
+/*
+ * Grabbed keys and buttons come with modifiers whose own presses
+ * AHWM never saw, so we press and release modifier keys to match the
+ * recorded state.  Caps Lock is left alone since pressing it toggles.
+ */
+
+static void set_modifiers(unsigned int state)
+{
+    unsigned int bit;
+    KeyCode key;
+
+    state &= ~LockMask;
+    for (bit = 0; bit < 8; bit++) {
+        if (((state ^ modifiers) & (1 << bit)) == 0) continue;
+        key = modmap->modifiermap[bit * modmap->max_keypermod];
+        if (key == 0) continue;
+        XTestFakeKeyEvent(ctl, key, (state & (1 << bit)) != 0, 0);
+    }
+    modifiers = state & 0xff;
+}
+
+/*
+ * A window is recorded on every MapRequest, so one we have already
+ * made a stand-in for is being mapped again.  We reuse the stand-in,
+ * which may still be mapped and managed if its unmap was one we
+ * couldn't replay, so withdraw it first.
+ */
+
+static void replay_window(recorded_window *rw)
+{
+    Window w;
+    unsigned int width, height;
+
+    width = rw->width > 0 ? rw->width : 1;
+    height = rw->height > 0 ? rw->height : 1;
+    w = window_for(rw->window);
+    if (w != None && w != root) {
+        withdraw(w);
+        XMoveResizeWindow(cli, w, rw->x, rw->y, width, height);
+        XSetWindowBorderWidth(cli, w, rw->border);
+    } else {
+        w = XCreateSimpleWindow(cli, root, rw->x, rw->y, width, height,
+                                rw->border,
+                                BlackPixel(cli, DefaultScreen(cli)),
+                                WhitePixel(cli, DefaultScreen(cli)));
+        map_add(&windows, &nwindows, rw->window, w);
+    }
+    if (rw->mapped) pending_map = w;
+}
+
+/* unmap W the ICCCM way, so the window manager lets go of it */
+static void withdraw(Window w)
+{
+    XEvent e;
+
+    XUnmapWindow(cli, w);
+    memset(&e, 0, sizeof(e));
+    e.xunmap.type = UnmapNotify;
+    e.xunmap.event = root;
+    e.xunmap.window = w;
+    XSendEvent(cli, root, False,
+               SubstructureRedirectMask | SubstructureNotifyMask, &e);
+}
+
+static void replay_property(recorded_property *rp, unsigned char *data)
+{
+    Window w;
+    Atom property, type;
+    long *longs;
+    unsigned long i;
+
+    w = window_for(rp->window);
+    property = atom_for(rp->atom);
+    if (w == None || property == None) return;
+    if (rp->type == None) {
+        XDeleteProperty(cli, w, property);
+        return;
+    }
+    type = atom_for(rp->type);
+    if (type == None) return;
+    if (rp->format == 32) {
+        longs = malloc(rp->nitems * sizeof(long) + 1);
+        if (longs == NULL) return;
+        for (i = 0; i < rp->nitems; i++)
+            longs[i] = ((CARD32 *)data)[i];
+        XChangeProperty(cli, w, property, type, 32, PropModeReplace,
+                        (unsigned char *)longs, rp->nitems);
+        free(longs);
+    } else {
+        XChangeProperty(cli, w, property, type, rp->format,
+                        PropModeReplace, data, rp->nitems);
+    }
+}
+
+static void replay_event(recorded_event *re)
+{
+    XWindowChanges wc;
+    XEvent e;
+    Window w;
+    int i;
+
+    w = window_for(re->window);
+    switch (re->type) {
+        case KeyPress:
+        case KeyRelease:
+            XTestFakeMotionEvent(ctl, -1, re->x_root, re->y_root, 0);
+            set_modifiers(re->state);
+            XTestFakeKeyEvent(ctl, re->detail, re->type == KeyPress, 0);
+            break;
+        case ButtonPress:
+        case ButtonRelease:
+            XTestFakeMotionEvent(ctl, -1, re->x_root, re->y_root, 0);
+            set_modifiers(re->state);
+            XTestFakeButtonEvent(ctl, re->detail,
+                                 re->type == ButtonPress, 0);
+            break;
+        case MotionNotify:
+        case EnterNotify:
+            XTestFakeMotionEvent(ctl, -1, re->x_root, re->y_root, 0);
+            break;
+        case MapRequest:
+            if (w == None) goto skip;
+            XMapWindow(cli, w);
+            break;
+        case ConfigureRequest:
+            if (w == None) goto skip;
+            wc.x = re->x;
+            wc.y = re->y;
+            wc.width = re->width > 0 ? re->width : 1;
+            wc.height = re->height > 0 ? re->height : 1;
+            wc.border_width = re->border;
+            wc.sibling = window_for(re->above);
+            wc.stack_mode = re->stack_mode;
+            if (wc.sibling == None) re->detail &= ~CWSibling;
+            XConfigureWindow(cli, w, re->detail, &wc);
+            break;
+        case CirculateRequest:
+            if (w == None) goto skip;
+            if (re->detail == PlaceOnTop)
+                XRaiseWindow(cli, w);
+            else
+                XLowerWindow(cli, w);
+            break;
+        case UnmapNotify:
+            /* only a client's own withdrawal, announced by a
+             * synthetic UnmapNotify, can be told from our own unmaps */
+            if (w == None || !re->send_event) goto skip;
+            withdraw(w);
+            break;
+        case DestroyNotify:
+            if (w == None || w == root) goto skip;
+            XDestroyWindow(cli, w);
+            map_remove(windows, &nwindows, re->window);
+            break;
+        case ClientMessage:
+            if (w == None || atom_for(re->detail) == None) goto skip;
+            memset(&e, 0, sizeof(e));
+            e.xclient.type = ClientMessage;
+            e.xclient.window = w;
+            e.xclient.message_type = atom_for(re->detail);
+            e.xclient.format = re->format;
+            for (i = 0; i < 5; i++)
+                e.xclient.data.l[i] = re->data[i];
+            XSendEvent(ctl, root, False,
+                       SubstructureRedirectMask | SubstructureNotifyMask, &e);
+            break;
+        case PropertyNotify:
+            /* the new value was replayed just before */
+            break;
+        default:
+            /* everything else follows from what we do replay */
+            goto skip;
+    }
+    if (re->type < LASTEvent) counts[re->type]++;
+    return;
+skip:
+    skipped++;
+}
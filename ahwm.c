@@ -48,6 +48,11 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SPAWN_H
+#include <spawn.h>
+#endif
 
 #include "ahwm.h"
 #include "event.h"
@@ -57,14 +62,23 @@
 #include "cursor.h"
 #include "move-resize.h"
 #include "kill.h"
+#include "ipc.h"
+#include "snapshot.h"
 #include "workspace.h"
 #include "icccm.h"
 #include "ewmh.h"
 #include "paint.h"
+#include "font.h"
 #include "mwm.h"
 #include "colormap.h"
 #include "timer.h"
 #include "prefs.h"
+#include "malloc.h"
+#include "flight.h"
+#include "xstats.h"
+#include "latency.h"
+#include "record.h"
+#include "atoms.h"
 
 Display *dpy;
 int scr;
@@ -105,10 +119,10 @@ static int tmp_error_handler(Display *dpy, XErrorEvent *error);
 static int error_handler(Display *dpy, XErrorEvent *error);
 static void scan_windows();
 static void reposition(Window w);
-static void sigterm(int signo);
 static void sigsegv(int signo);
 static void crash_handler();
 static void gcore();
+static pid_t spawn(char **argv);
 static void crashwin_draw(GC gc, Window toplevel, Window button1,
                           Window button2, Window button3,
                           int height, int width);
@@ -156,6 +170,8 @@ int main(int argc, char **argv)
     sigemptyset(&set);
     sigprocmask(SIG_SETMASK, &set, NULL);
     argv0 = argv[0];
+    malloc_init();
+    flight_init();
 #ifdef DEBUG
     /* set non-buffered */
     setvbuf(stdout, NULL, _IONBF, 0);
@@ -201,15 +217,15 @@ int main(int argc, char **argv)
     XSynchronize(dpy, True);
 #endif
 
-    /* set up our global variables */
+    /* set up our global variables (the atoms get values below) */
     
-    WM_STATE = XInternAtom(dpy, "WM_STATE", False);
-    WM_CHANGE_STATE = XInternAtom(dpy, "WM_CHANGE_STATE", False);
-    WM_TAKE_FOCUS = XInternAtom(dpy, "WM_TAKE_FOCUS", False);
-    WM_SAVE_YOURSELF = XInternAtom(dpy, "WM_SAVE_YOURSELF", False);
-    WM_DELETE_WINDOW = XInternAtom(dpy, "WM_DELETE_WINDOW", False);
-    WM_PROTOCOLS = XInternAtom(dpy, "WM_PROTOCOLS", False);
-    _AHWM_MOVE_OFFSET = XInternAtom(dpy, "_AHWM_MOVE_OFFSET", False);
+    atoms_declare(&WM_STATE, "WM_STATE");
+    atoms_declare(&WM_CHANGE_STATE, "WM_CHANGE_STATE");
+    atoms_declare(&WM_TAKE_FOCUS, "WM_TAKE_FOCUS");
+    atoms_declare(&WM_SAVE_YOURSELF, "WM_SAVE_YOURSELF");
+    atoms_declare(&WM_DELETE_WINDOW, "WM_DELETE_WINDOW");
+    atoms_declare(&WM_PROTOCOLS, "WM_PROTOCOLS");
+    atoms_declare(&_AHWM_MOVE_OFFSET, "_AHWM_MOVE_OFFSET");
 
 #ifdef SHAPE
     shape_supported = XShapeQueryExtension(dpy, &shape_event_base, &junk);
@@ -229,33 +245,31 @@ int main(int argc, char **argv)
 #endif
     
     prefs_init();
+    xstats_init();
+
+    /* every module's atoms in one round trip; see atoms.h */
+    colormap_declare_atoms();
+    icccm_declare_atoms();
+    ewmh_declare_atoms();
+    mwm_declare_atoms();
+    focus_declare_atoms();
+    kill_declare_atoms();
+    latency_declare_atoms();
+    atoms_intern();
+
     icccm_init();
     ewmh_init();
-    mwm_init();
     focus_init();
     kill_init();
     timer_init();
+    latency_init();
+    event_init(xfd);
+    ipc_init();
+    snapshot_init();
 
     /* we need to set ahwm_fontname (in prefs_init())
      * before we load the font and create the GCs */
-    fontstruct = XLoadQueryFont(dpy, ahwm_fontname);
-    if (fontstruct == NULL) {
-        fprintf(stderr, "AHWM: Could not load font \"%s\".  "
-                "Using default font instead.\n", ahwm_fontname);
-        /* now this font name should never fail */
-        ahwm_fontname = "-*-*-*-*-*-*-*-*-*-*-*-*-*-*";
-        fontstruct = XLoadQueryFont(dpy, ahwm_fontname);
-        if (fontstruct == NULL) {
-            /* Could not load any fonts.  Might happen if user uses
-             * and misconfigures font server or something.  Might try
-             * to continue without titlebars. */
-            fprintf(stderr, "AHWM: Could not load any fonts at all.\n");
-            fprintf(stderr, "AHWM: This is a fatal error - quitting.\n");
-            exit(1);
-        }
-    }
-    TITLE_HEIGHT = fontstruct->max_bounds.ascent + fontstruct->max_bounds.descent;
-    paint_ascent = fontstruct->max_bounds.ascent;
+    font_init(ahwm_fontname);
 
     if (XAllocNamedColor(dpy, DefaultColormap(dpy, scr), "#E0E0E0",
                          &xcolor, &junk2) == 0) {
@@ -293,12 +307,12 @@ int main(int argc, char **argv)
 #ifdef HAVE_ATEXIT
     atexit(focus_save_stacks);
 #endif
-    signal(SIGTERM, sigterm);
 #ifndef DEBUG
     signal(SIGSEGV, sigsegv);
     signal(SIGBUS, sigsegv);
 #endif
     
+    record_init();
     scan_windows();
     focus_load_stacks();
     
@@ -419,33 +433,104 @@ static void reposition(Window w)
     XFree(offset);
 }
 
-/* standard double fork trick, don't leave zombies */
+/*
+ * If a command contains any of these, we need /bin/sh to run it.
+ * Otherwise, splitting on whitespace is all the shell would do, and
+ * we save ourselves an exec by doing it ourselves.
+ */
+
+#define SHELL_METACHARACTERS "|&;<>()$`\\\"'*?[]#~=%!{}\n"
+
+/* most we'll split a command into before we give up and use a shell */
+#define MAX_DIRECT_ARGS 64
+
+/*
+ * Launching programs is latency-sensitive (people notice how long it
+ * takes for a terminal to appear), so we avoid copying the window
+ * manager's address space with fork() where possible and skip the
+ * shell when it isn't needed.  Children are reaped from the event
+ * loop on SIGCHLD, so we never wait for them here.
+ */
 /* anything that takes an 'arglist' argument is a bindable
  * function which appears in the config file; see prefs.c:fn_table */
 void run_program(XEvent *e, struct _arglist *args)
 {
-    pid_t pid;
-    char *progname;
+    char *progname, *cp;
+    char *argv[MAX_DIRECT_ARGS + 1];
+    char buf[1024];
     struct _arglist *p;
+    int argc;
 
     fflush(stdout);
     fflush(stderr);
     for (p = args; p != NULL; p = p->arglist_next) {
         progname = p->arglist_arg->type_value.stringval;
-        if ( (pid = fork()) == 0) {
-            close(ConnectionNumber(dpy));
-            if (fork() == 0) {
-                execl("/bin/sh", "/bin/sh", "-c", progname, NULL);
+
+        argc = 0;
+        if (strpbrk(progname, SHELL_METACHARACTERS) == NULL
+            && strlen(progname) < sizeof(buf)) {
+
+            strcpy(buf, progname);
+            cp = strtok(buf, " \t");
+            while (cp != NULL && argc <= MAX_DIRECT_ARGS) {
+                argv[argc++] = cp;
+                cp = strtok(NULL, " \t");
             }
-            _exit(0);
-        } else if (pid > 0) {
-            wait(NULL);
-        } else {
-            perror("AHWM: fork");
+        }
+        if (argc == 0 || argc > MAX_DIRECT_ARGS) {
+            argv[0] = "/bin/sh";
+            argv[1] = "-c";
+            argv[2] = progname;
+            argc = 3;
+        }
+        argv[argc] = NULL;
+
+        if (spawn(argv) < 0) {
+            fprintf(stderr, "AHWM: Could not run '%s': %s\n",
+                    progname, strerror(errno));
         }
     }
 }
 
+/*
+ * Start a program without waiting for it.  The event loop blocks
+ * some signals, which we mustn't pass on to the child.  Our X
+ * connection is close-on-exec.
+ */
+
+static pid_t spawn(char **argv)
+{
+    extern char **environ;
+    sigset_t set;
+    pid_t pid;
+#ifdef HAVE_POSIX_SPAWNP
+    posix_spawnattr_t attr;
+    int err;
+#endif
+
+    sigemptyset(&set);
+#ifdef HAVE_POSIX_SPAWNP
+    /* glibc and the BSDs implement this with vfork() or equivalent */
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &set);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+    err = posix_spawnp(&pid, argv[0], NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+#else
+    pid = fork();
+    if (pid == 0) {
+        sigprocmask(SIG_SETMASK, &set, NULL);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+#endif
+    return pid;
+}
+
 void ahwm_quit(XEvent *e, struct _arglist *ignored)
 {
 #ifdef DEBUG
@@ -467,26 +552,6 @@ void ahwm_restart(XEvent *e, struct _arglist *ignored)
     _exit(1);
 }
 
-/*
- * Call atexit() functions instead of terminating immediately on
- * SIGTERM.  (The default SIGTERM behaviour will not call atexit()
- * functions.)
- * 
- * Problem is that we aren't supposed to call any Xlib functions in a
- * signal handler as Xlib isn't reentrant.  This might screw things up
- * royally.  We could simply set a flag for the event-dispatcher
- * function.  However, someone might have sent us SIGTERM because AHWM
- * is hung, and we may never get back to the dispatcher function.
- * Can't really come up with an optimal solution, but going ahead and
- * calling the Xlib functions from a signal handler works *some* of
- * the time.
- */
-
-static void sigterm(int signo)
-{
-    exit(0);
-}
-
 #ifdef DEBUG
 /* make it easier to read debug output */
 static void mark(XEvent *e, struct _arglist *ignored)
@@ -525,9 +590,13 @@ static void mark(XEvent *e, struct _arglist *ignored)
  * 2.  '*argv0' is corrupted.
  * 3.  heap is corrupted and libc's execlp needs to use heap.
  * 4.  PATH environment variable is corrupted.
+ * 
+ * First, though, we write out the flight recorder (see flight.h),
+ * which needs nothing but open() and write().
  */
 static void sigsegv(int signo)
 {
+    flight_dump(NULL);
 	gcore();
     /* third arg points into ro-data segment */
     execlp(argv0, argv0, "--segv", NULL);
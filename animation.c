@@ -23,19 +23,30 @@
  * SUCH DAMAGE.
  */
 
+#include "config.h"
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <stdlib.h>
+
 #include "animation.h"
+#include "pool.h"
 #include "timer.h"
+#include "ahwm.h"
 
-#include <stdlib.h>
+#define NMULTIPLICANDS 65
 
-#define ANIMATION_INTERVAL 8  /* milliseconds */
+int animation_length = 520;      /* milliseconds */
+int animation_frame_rate = 125;  /* frames per second */
 
 struct _animation {
-    int i;
+    float position;             /* how far along we are, 0.0 to 1.0 */
+    struct timeval last;        /* when position was last updated */
     void *v;
     callback_fn callback;
     finalize_fn finalize;
     int forwards;
+    struct _animation *next;
 };
 
 /*
@@ -44,11 +55,12 @@ struct _animation {
  * Theory and its Applications vol. 1, William Feller, 1950.  The last
  * element should be 1.0.  We approximate that Phi(3.2) = 1.0.
  * 
- * This gives a very pleasing aesthetic effect.  With these
- * parameters, it takes around half a second to complete an animation.
+ * This gives a very pleasing aesthetic effect.  We interpolate
+ * linearly between the entries, so the curve is independent of the
+ * frame rate.
  */
 
-float animation_multiplicands[65] = {
+float animation_multiplicands[NMULTIPLICANDS] = {
     0.000000,
     0.000968, 0.001350, 0.001866, 0.002555, 0.003467, 0.004661, 0.006210,
     0.008198, 0.010724, 0.013903, 0.017864, 0.022750, 0.028717, 0.035930,
@@ -62,20 +74,29 @@ float animation_multiplicands[65] = {
     1.000000
 };
 
-static void animate_fire(timer *t, void *v);
+/* running animations, all driven by frame_timer */
+static animation *animations = NULL;
+static timer *frame_timer = NULL;
+
+static void animation_frame(timer *t, void *ignored);
+static void animation_schedule();
+static float curve(float position);
 
 animation *animate(callback_fn callback, finalize_fn finalize, void *v)
 {
     animation *data;
 
-    data = malloc(sizeof(animation));
+    data = pool_alloc(sizeof(animation));
     if (data == NULL) return NULL;
-    data->i = 0;
+    data->position = 0.0;
+    timer_now(&data->last);
     data->v = v;
     data->callback = callback;
     data->finalize = finalize;
     data->forwards = 1;
-    timer_new(ANIMATION_INTERVAL, animate_fire, (void *)data);
+    data->next = animations;
+    animations = data;
+    animation_schedule();
     return data;
 }
 
@@ -87,31 +108,106 @@ void animation_reverse(animation *data)
 void animation_start_backwards(animation *data)
 {
     animation_reverse(data);
-    data->i = (sizeof(animation_multiplicands) / sizeof(float)) - data->i - 1;
+    data->position = 1.0 - data->position;
 }
 
-static void animate_fire(timer *t, void *v)
+/*
+ * Make sure the frame timer is running if there's anything to
+ * animate.  The first frame of a new animation waits for the next
+ * tick of the shared clock rather than starting its own.  The frame
+ * timer is periodic and is created once; it is only disarmed and
+ * rearmed after that.
+ */
+
+static void animation_schedule()
 {
-    animation *data = (animation *)v;
+    int interval;
 
-    (data->callback)(animation_multiplicands[data->i], data->v);
+    if (animations == NULL) return;
+    if (frame_timer != NULL && timer_pending(frame_timer)) return;
 
-    timer_cancel(t);
-    if (data->forwards) {
-        data->i++;
-        if (data->i == sizeof(animation_multiplicands) / sizeof(float)) {
-            if (data->finalize != NULL) (data->finalize)(data->v);
-            free(data);
+    interval = 1000 / (animation_frame_rate > 0 ? animation_frame_rate : 1);
+    if (interval < 1) interval = 1;
+    if (frame_timer == NULL) {
+        frame_timer = timer_new_periodic(interval, animation_frame, NULL);
+    } else {
+        timer_rearm(frame_timer, interval);
+    }
+}
+
+/*
+ * Advance each animation by however much time has passed since we
+ * last looked at it, call the callbacks, and flush the whole frame to
+ * the server in one go.
+ */
+
+static void animation_frame(timer *t, void *ignored)
+{
+    animation *data, *prev, *next;
+    struct timeval now;
+    long elapsed;
+    float step;
+    int done;
+
+    timer_now(&now);
+
+    prev = NULL;
+    for (data = animations; data != NULL; data = next) {
+        next = data->next;
+
+        /* in microseconds, so no part of a frame is lost */
+        elapsed = (now.tv_sec - data->last.tv_sec) * 1000000
+            + (now.tv_usec - data->last.tv_usec);
+        data->last = now;
+        if (animation_length <= 0) {
+            step = 1.0;
         } else {
-            timer_new(ANIMATION_INTERVAL, animate_fire, v);
+            step = (float)elapsed / ((float)animation_length * 1000.0);
         }
-    } else {
-        data->i--;
-        if (data->i < 0) {
+
+        if (data->forwards) {
+            data->position += step;
+            done = data->position >= 1.0;
+            if (done) data->position = 1.0;
+        } else {
+            data->position -= step;
+            done = data->position <= 0.0;
+            if (done) data->position = 0.0;
+        }
+
+        (data->callback)(curve(data->position), data->v);
+
+        if (done) {
+            if (prev != NULL) {
+                prev->next = next;
+            } else {
+                animations = next;
+            }
             if (data->finalize != NULL) (data->finalize)(data->v);
-            free(data);
+            pool_free(data, sizeof(animation));
         } else {
-            timer_new(ANIMATION_INTERVAL, animate_fire, v);
+            prev = data;
         }
     }
+
+    XFlush(dpy);
+    if (animations == NULL) {
+        timer_disarm(t);
+    }
+}
+
+/* map linear progress onto the accelerate/decelerate curve */
+static float curve(float position)
+{
+    float x;
+    int i;
+
+    if (position <= 0.0) return animation_multiplicands[0];
+    if (position >= 1.0) return animation_multiplicands[NMULTIPLICANDS - 1];
+
+    x = position * (NMULTIPLICANDS - 1);
+    i = (int)x;
+    return animation_multiplicands[i]
+        + (x - i) * (animation_multiplicands[i + 1]
+                     - animation_multiplicands[i]);
 }
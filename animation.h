@@ -27,6 +27,12 @@
  * Calls a callback function at a certain frequency, providing a
  * cartoonish accelerate/decelerate effect useful for shading,
  * automated moving, etc.
+ *
+ * All running animations are driven from a single frame timer.  Each
+ * frame, every animation is advanced according to how much time has
+ * actually elapsed, so a slow frame makes the animation skip ahead
+ * rather than take longer.  The X requests made by all the callbacks
+ * in one frame are flushed together at the end of the frame.
  */
 
 #ifndef ANIMATION_H
@@ -35,6 +41,19 @@
 struct _animation;
 typedef struct _animation animation;
 
+/*
+ * How long an animation takes from start to finish, in milliseconds.
+ * Zero means animations finish on the first frame.  Set from the
+ * AnimationLength option.
+ */
+extern int animation_length;
+
+/*
+ * How many frames per second we try to draw.  Set from the
+ * AnimationFrameRate option; must be positive.
+ */
+extern int animation_frame_rate;
+
 /*
  * Callback functions take two parameters:  a data member which you
  * define when you start the animation and a float which represents
@@ -56,15 +75,16 @@ typedef void (*finalize_fn)(void *);
 animation *animate(callback_fn callback, finalize_fn finalize, void *v);
 
 /*
- * Reverse sets the animation to go backwards, retracing the last step.
- * If the animation has already completed n steps, it will do those n steps
- * again, but backwards
+ * Reverse sets the animation to go backwards, retracing its path.  If
+ * the animation has already been running for n milliseconds, it will
+ * take n milliseconds to get back to where it started.
  */
 void animation_reverse(animation *);
 
 /*
  * start_backwards is like reverse, except instead of retracing the
- * last n steps, it starts retracing from the last minus nth step.
+ * path already covered, it runs the remainder of the animation from
+ * the far end back towards the start.
  */
 void animation_start_backwards(animation *);
 
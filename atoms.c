@@ -0,0 +1,85 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ahwm.h"
+#include "atoms.h"
+#include "malloc.h"
+#include "debug.h"
+
+static Atom **atoms = NULL;
+static char **names = NULL;
+static int natoms = 0, natoms_allocated = 0;
+
+/* we're only called at start-up, so running out of memory is fatal */
+void atoms_declare(Atom *atom, char *name)
+{
+    if (natoms == natoms_allocated) {
+        natoms_allocated = natoms_allocated == 0 ? 64 : natoms_allocated * 2;
+        atoms = Realloc(atoms, natoms_allocated * sizeof(Atom *));
+        names = Realloc(names, natoms_allocated * sizeof(char *));
+    }
+    if (atoms == NULL || names == NULL
+        || (names[natoms] = Strdup(name)) == NULL) {
+        perror("AHWM: atoms_declare: malloc");
+        fprintf(stderr, "AHWM: this is a fatal error, quitting.\n");
+        exit(1);
+    }
+    atoms[natoms++] = atom;
+}
+
+void atoms_intern()
+{
+    Atom *result;
+    int i;
+
+    if (natoms == 0) return;
+    result = Malloc(natoms * sizeof(Atom));
+    if (result == NULL) {
+        perror("AHWM: atoms_intern: malloc");
+        fprintf(stderr, "AHWM: this is a fatal error, quitting.\n");
+        exit(1);
+    }
+    if (XInternAtoms(dpy, names, natoms, False, result) == 0) {
+        fprintf(stderr, "AHWM: could not intern atoms, quitting.\n");
+        exit(1);
+    }
+    debug(("interned %d atoms\n", natoms));
+    for (i = 0; i < natoms; i++) {
+        *atoms[i] = result[i];
+        Free(names[i]);
+    }
+    Free(result);
+    Free(atoms);
+    Free(names);
+    atoms = NULL;
+    names = NULL;
+    natoms = natoms_allocated = 0;
+}
@@ -0,0 +1,58 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef ATOMS_H
+#define ATOMS_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+
+/*
+ * The atom registry.  Interning atoms one XInternAtom() at a time
+ * costs a round trip each, which adds up to a hundred or so at
+ * start-up and is slow over a remote connection.  Instead, every
+ * module declares the atoms it needs in its _declare_atoms()
+ * function, which main() calls after prefs_init() (so per-workspace
+ * atoms can be declared), and then atoms_intern() fills them all in
+ * with one XInternAtoms() call.  No module may use its atoms before
+ * that, so _init() functions which need them run afterwards.
+ */
+
+/*
+ * Have *ATOM set to the atom called NAME by atoms_intern().  NAME is
+ * copied.
+ */
+
+void atoms_declare(Atom *atom, char *name);
+
+/*
+ * Intern every atom declared so far, with one round trip, and forget
+ * the declarations.
+ */
+
+void atoms_intern();
+
+#endif /* ATOMS_H */
@@ -52,7 +52,11 @@
 #include "prefs.h"
 #include "mwm.h"
 #include "colormap.h"
+#include "paint.h"
+#include "font.h"
+#include "kill.h"
 #include "compat.h"
+#include "trace.h"
 
 int TITLE_HEIGHT = 15;
 
@@ -94,9 +98,9 @@ client_t *client_create(Window w)
         return NULL;
     }
 
-    client = Malloc(sizeof(client_t));
+    client = pool_alloc(sizeof(client_t));
     if (client == NULL) {
-        fprintf(stderr, "AHWM: Malloc failed, unable to allocate client\n");
+        fprintf(stderr, "AHWM: out of memory, unable to allocate client\n");
         return NULL;
     }
     memset(client, 0, sizeof(client_t));
@@ -117,6 +121,7 @@ client_t *client_create(Window w)
     client->color_index = 0;
     client->colormap = xwa.colormap;
     client->colormap_windows = NULL;
+    client->colormap_window_maps = NULL;
     client->ncolormap_windows = 0;
     client->pass_focus_click = 1;
     client->focus_policy = SloppyFocus;
@@ -214,14 +219,18 @@ client_t *client_create(Window w)
     client_create_frame(client, &requested_geometry);
     if (client->frame == None) {
         fprintf(stderr, "AHWM: Could not create frame\n");
-        Free(client);
+        kill_ping_remove(client);
+        arena_release(&client->strings);
+        pool_free(client, sizeof(client_t));
         return NULL;
     }
     if (client->has_titlebar) client_add_titlebar_internal(client);
 
     if (XSaveContext(dpy, w, window_context, (void *)client) != 0) {
         fprintf(stderr, "AHWM: XSaveContext failed, could not save window\n");
-        Free(client);
+        kill_ping_remove(client);
+        arena_release(&client->strings);
+        pool_free(client, sizeof(client_t));
         return NULL;
     }
     
@@ -270,6 +279,7 @@ client_t *client_create(Window w)
         client_inform_state(client);
     }
     
+    TRACE1(client_create, client->window);
     return client;
 }
 
@@ -458,6 +468,7 @@ void client_remove_titlebar(client_t *client)
     }
 
     client_position_noframe(client, &ps);
+    paint_titlebar_release(client);
     XUnmapWindow(dpy, client->titlebar);
     XDestroyWindow(dpy, client->titlebar);
     XDeleteContext(dpy, client->titlebar, title_context);
@@ -500,6 +511,7 @@ void client_destroy(client_t *client)
 {
     client_t *c, *tmp;
 
+    TRACE1(client_destroy, client->window);
     stacking_remove(client);
     /* apparently we need this here */
     remove_transient_from_leader(client);
@@ -510,12 +522,15 @@ void client_destroy(client_t *client)
     }
 
     ewmh_client_list_remove(client);
+    colormap_forget(client);
+    kill_ping_remove(client);
     
     XDeleteContext(dpy, client->window, window_context);
     XDeleteContext(dpy, client->frame, frame_context);
     XUnmapWindow(dpy, client->frame);
     XDestroyWindow(dpy, client->frame);
     if (client->titlebar != None) {
+        paint_titlebar_release(client);
         XDeleteContext(dpy, client->titlebar, title_context);
         XUnmapWindow(dpy, client->titlebar);
         XDestroyWindow(dpy, client->titlebar);
@@ -523,11 +538,9 @@ void client_destroy(client_t *client)
     if (client->xwmh != NULL
         && client->group_leader == NULL)
         XFree(client->xwmh);
-    Free(client->name);         /* should never be NULL */
-    if (client->instance != NULL) XFree(client->instance);
-    if (client->class != NULL) XFree(client->class);
+    arena_release(&client->strings); /* name, instance and class */
 
-    Free(client);
+    pool_free(client, sizeof(client_t));
 }
 
 /* snarfed mostly from ctwm and WindowMaker */
@@ -535,48 +548,76 @@ void client_destroy(client_t *client)
 void client_set_name(client_t *client)
 {
     XTextProperty xtp;
-    char **list;
+    char **list, *name;
     int n;
 
+    if (font_utf8) {
+        name = ewmh_get_wm_name(client);
+        if (name != NULL) {
+            client_set_name_string(client, name);
+            Free(name);
+            return;
+        }
+    }
     if (XGetWMName(dpy, client->window, &xtp) == 0) {
-        client->name = Strdup("");      /* client did not set a window name */
+        client_set_name_string(client, ""); /* client did not set a name */
         return;
     }
+    list = NULL;
     if (xtp.value == NULL || xtp.nitems <= 0) {
         /* client set window name to NULL */
-        client->name = Strdup("");
+        name = "";
+    } else if (font_utf8) {
+        /* converts both Latin-1 and compound text */
+        if (Xutf8TextPropertyToTextList(dpy, &xtp, &list, &n) >= Success
+            && n > 0 && *list != NULL) {
+            name = *list;
+        } else {
+            name = (char *)xtp.value;
+        }
     } else {
         if (xtp.encoding == XA_STRING) {
             /* usual case */
-            client->name = Strdup((char *)xtp.value);
+            name = (char *)xtp.value;
         } else {
             /* client is using UTF-16 or something equally stupid */
             /* haven't seen this block actually run yet */
             xtp.nitems = strlen((char *)xtp.value);
             if (XmbTextPropertyToTextList(dpy, &xtp, &list, &n) == Success
                 && n > 0 && *list != NULL) {
-                client->name = Strdup(*list);
-                XFreeStringList(list);
+                name = *list;
             } else {
-                client->name = Strdup("");
+                name = "";
             }
         }
     }
+    client_set_name_string(client, name);
+    if (list != NULL) XFreeStringList(list);
     if (xtp.value != NULL) XFree(xtp.value);
 
     debug(("\tClient %#lx is %s\n", (unsigned int)client, client->name));
 }
 
+void client_set_name_string(client_t *client, char *name)
+{
+    paint_titlebar_invalidate(client);
+    if (arena_set(&client->strings, &client->name, name) == NULL) {
+        client->name = "";      /* out of memory, but never NULL */
+    }
+}
+
 void client_set_instance_class(client_t *client)
 {
     XClassHint xch;
 
-    client->class = NULL;
-    client->instance = NULL;
-
     if (XGetClassHint(dpy, client->window, &xch) != 0) {
-        client->instance = xch.res_name;
-        client->class = xch.res_class;
+        arena_set(&client->strings, &client->instance, xch.res_name);
+        arena_set(&client->strings, &client->class, xch.res_class);
+        if (xch.res_name != NULL) XFree(xch.res_name);
+        if (xch.res_class != NULL) XFree(xch.res_class);
+    } else {
+        arena_set(&client->strings, &client->instance, NULL);
+        arena_set(&client->strings, &client->class, NULL);
     }
 }
 
@@ -836,6 +877,7 @@ void client_set_protocols(client_t *client)
 
     client->protocols = PROTO_NONE;
     if (XGetWMProtocols(dpy, client->window, &atoms, &n) == 0) {
+        kill_ping_update(client);
         return;
     } else {
         for (i = 0; i < n; i++) {
@@ -845,10 +887,13 @@ void client_set_protocols(client_t *client)
                 client->protocols |= PROTO_SAVE_YOURSELF;
             } else if (atoms[i] == WM_DELETE_WINDOW) {
                 client->protocols |= PROTO_DELETE_WINDOW;
+            } else if (atoms[i] == _NET_WM_PING) {
+                client->protocols |= PROTO_PING;
             }
         }
     }
     if (atoms != NULL) XFree(atoms);
+    kill_ping_update(client);
 }
 
 void client_sendmessage(client_t *client, Atom data0, Time timestamp,
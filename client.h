@@ -28,6 +28,9 @@
 #include "config.h"
 
 #include "ahwm.h"
+#include "pool.h"
+
+#include <sys/time.h>
 
 /* height of the titlebar, should probably be configurable */
 /* FIXME */
@@ -46,6 +49,45 @@ typedef enum _option_setting {
     UnSet = 0, UserSet, HintSet, UserOverridden
 } option_setting;
 
+/*
+ * Cached images of a client's titlebar; see paint.c.  The images are
+ * installed as the titlebar's background, so the server repaints the
+ * titlebar on exposure without asking us.  Everything after the
+ * 'valid' member is the state the images were drawn for.
+ */
+
+typedef struct _title_cache {
+    Pixmap pixmap[2];           /* unfocused and focused images */
+    Pixmap installed;           /* current background or None */
+    Region damage;              /* exposed since last repaint, or NULL */
+    int pixmap_width;           /* allocated width of both pixmaps */
+    Bool valid[2];              /* images up to date? */
+    int width;
+    int color_index;
+    int title_position;
+    unsigned int buttons;
+} title_cache;
+
+/*
+ * How much of a client's title fits on its titlebar and where it
+ * goes; see paint.c.  'valid' is cleared when the name changes; the
+ * rest is redone when room, room_left or position no longer match.
+ */
+
+typedef struct _title_layout {
+    Bool valid;
+    int name_len;               /* strlen(name) */
+    int width;                  /* width of the whole name */
+    int room;                   /* space between the buttons */
+    int room_left;              /* where that space starts */
+    int position;               /* title_position */
+    int len;                    /* bytes of the name shown */
+    int len_width;              /* width of those bytes */
+    int shown_width;            /* including any ellipsis */
+    int x;                      /* where the title starts */
+    Bool ellipsized;
+} title_layout;
+
 /*
  * this is the information we store with each top-level window EXCEPT
  * for those windows which have override_redirect set (the ONLY thing
@@ -79,6 +121,7 @@ typedef struct _client_t {
     Colormap colormap;          /* from XGetWindowAttributes() */
     Window *colormap_windows;   /* ICCCM WM_COLORMAP_WINDOWS property */
     unsigned long ncolormap_windows; /* number of windows in colormap_windows */
+    Colormap *colormap_window_maps; /* their colormaps, see colormap.c */
     int x;                      /* frame's actual position when mapped */
     int y;                      /* frame's actual position when mapped */
     int width;                  /* frame's actual size when mapped */
@@ -91,10 +134,12 @@ typedef struct _client_t {
     unsigned int workspace;     /* client's workspace, see workspace.h */
     unsigned int protocols;     /* WM_PROTOCOLS, see below (ICCCM, 4.1.2.7) */
     char *name;                 /* window's name (ICCCM, 4.1.2.1) */
-    /* will not be NULL; use Free() */
+    /* will not be NULL */
     char *instance;             /* window's instance (ICCCM, 4.1.2.5) */
     char *class;                /* window's class (ICCCM, 4.1.2.5) */
-    /* both of the above may be NULL; use XFree() on them */
+    /* both of the above may be NULL; all three live in 'strings'
+     * and must not be freed */
+    string_arena strings;
 
     /* The state is 'Withdrawn' when the window is created but is
      * not yet mapped and when the window has been unmapped but
@@ -110,6 +155,20 @@ typedef struct _client_t {
      * index).  Set and used by paint.c.  Default value is zero.
      */
     int color_index;
+
+    title_cache title_cache;    /* used by paint.c */
+    title_layout title_layout;  /* used by paint.c */
+
+    /* Clients which speak _NET_WM_PING are kept on a ring and
+     * pinged in the background by kill.c.  A ping is outstanding
+     * whenever ping_stamp != pong_stamp. */
+    struct _client_t *ping_next; /* ring of pinged clients or NULL */
+    struct _client_t *ping_prev;
+    struct timeval ping_sent;   /* when the last ping went out */
+    Time ping_stamp;            /* timestamp of the last ping sent */
+    Time pong_stamp;            /* timestamp of the last ping answered */
+    int ping_rtt;               /* last round trip in msecs, -1 if none */
+    Bool unresponsive;          /* outstanding ping is overdue */
     
     /* If some client has this client as the transient_for hint, then
      * this client is a 'leader' (my nomenclature, nothing to do with
@@ -179,6 +238,7 @@ typedef struct _client_t {
 #define PROTO_TAKE_FOCUS    01
 #define PROTO_SAVE_YOURSELF 02
 #define PROTO_DELETE_WINDOW 04
+#define PROTO_PING          010 /* _NET_WM_PING, EWMH */
 
 typedef struct _position_size {
     int x, y, width, height;
@@ -217,24 +277,27 @@ client_t *client_find(Window);
 void client_destroy(client_t *);
 
 /*
- * Figure out the name of a client and set it to a newly-malloced
- * string.  The name is found using the WM_NAME property, and this
- * function will always set the 'name' member of the client
- * argument to a newly-malloced string.  This will NOT free
- * the previous 'name' member.
+ * Figure out the name of a client using the WM_NAME property (or
+ * _NET_WM_NAME for UTF-8 titles) and set the 'name' member of the
+ * client to it, replacing the previous name.  The titlebar is marked
+ * for redrawing but not repainted.
  */
 
 void client_set_name(client_t *);
 
+/*
+ * Set the 'name' member of the client to a copy of NAME, the same
+ * way; used when we take over the titlebar to display something else.
+ */
+
+void client_set_name_string(client_t *, char *name);
+
 /*
  * Get the client's 'class' and 'instance' using the WM_CLASS
  * property and set the corresponding members in the client
- * structure to newly-allocated strings which contain this
- * information.  The 'class' and 'instance' members may be set
- * to NULL (unlike client_set_name()) if the application does
- * not supply this information; this function does NOT free
- * the member data at any time.  Use 'XFree()' to free the data,
- * NOT 'free()'.
+ * structure, replacing the previous values.  The 'class' and
+ * 'instance' members may be set to NULL (unlike client_set_name())
+ * if the application does not supply this information.
  */
 
 void client_set_instance_class(client_t *);
@@ -40,15 +40,20 @@
 #include <stdio.h>
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
+#include <X11/Xutil.h>
 
 #include "colormap.h"
+#include "atoms.h"
 #include "client.h"
 #include "focus.h"
+#include "malloc.h"
+#include "debug.h"
 
 Atom WM_COLORMAP_WINDOWS = None;
 
 static Atom WM_COLORMAP_NOTIFY = None;
 static Window icccm_colormap_policy_stealer = None;
+static XContext colormap_context;   /* colormap window -> client */
 
 /*
  * In this function, we should also
@@ -63,21 +68,30 @@ static Window icccm_colormap_policy_stealer = None;
 
 void colormap_init()
 {
-    WM_COLORMAP_WINDOWS = XInternAtom(dpy, "WM_COLORMAP_WINDOWS", False);
-    WM_COLORMAP_NOTIFY = XInternAtom(dpy, "WM_COLORMAP_NOTIFY", False);
+    colormap_context = XUniqueContext();
+}
+
+void colormap_declare_atoms()
+{
+    atoms_declare(&WM_COLORMAP_WINDOWS, "WM_COLORMAP_WINDOWS");
+    atoms_declare(&WM_COLORMAP_NOTIFY, "WM_COLORMAP_NOTIFY");
 }
 
 /*
- * We keep track of the client's WM_COLORMAP_WINDOWS property.  We
- * could instead keep track of the colormaps of those windows and
- * select for colormap change events on those windows to avoid the
- * (potentially slow) XGetWindowAttributes loop.  However, nobody uses
- * this.
+ * We keep track of the client's WM_COLORMAP_WINDOWS property and of
+ * the colormap of each window listed there: we select
+ * ColormapChangeMask on those windows and keep colormap_context
+ * mapping each of them back to its client.  Installing colormaps on
+ * a focus change then needs no round trips.  The client's own
+ * window may be in the list too; its colormap is client->colormap,
+ * which event.c already tracks.
  */
 
+#define MAX_COLORMAP_WINDOWS 256
+
 void colormap_install(client_t *client)
 {
-    XWindowAttributes xwa;
+    Colormap cmap;
     Bool installed_main_colormap;
     int i;
 
@@ -91,12 +105,14 @@ void colormap_install(client_t *client)
     }
     installed_main_colormap = False;
     for (i = 0; i < client->ncolormap_windows; i++) {
-        if (XGetWindowAttributes(dpy, client->colormap_windows[i], &xwa) == 0)
-            continue;
-        if (xwa.colormap == client->colormap)
+        if (client->colormap_windows[i] == client->window)
+            cmap = client->colormap;
+        else
+            cmap = client->colormap_window_maps[i];
+        if (cmap == client->colormap)
             installed_main_colormap = True;
-        if (xwa.colormap != None)
-            XInstallColormap(dpy, xwa.colormap);
+        if (cmap != None)
+            XInstallColormap(dpy, cmap);
     }
     if (installed_main_colormap == False) {
         if (client->colormap != None)
@@ -104,35 +120,102 @@ void colormap_install(client_t *client)
     }
 }
 
+/* stops tracking the windows, SELECT says whether they still exist */
+static void forget_windows(client_t *client, Bool select)
+{
+    int i;
+    
+    for (i = 0; i < client->ncolormap_windows; i++) {
+        if (client->colormap_windows[i] == client->window)
+            continue;
+        XDeleteContext(dpy, client->colormap_windows[i], colormap_context);
+        if (select)
+            XSelectInput(dpy, client->colormap_windows[i], NoEventMask);
+    }
+    if (client->colormap_windows != NULL)
+        XFree(client->colormap_windows);
+    if (client->colormap_window_maps != NULL)
+        Free(client->colormap_window_maps);
+    client->colormap_windows = NULL;
+    client->colormap_window_maps = NULL;
+    client->ncolormap_windows = 0;
+}
+
 void colormap_update_windows_property(client_t *client)
 {
     Atom actual;
-    int fmt;
+    int fmt, i;
     unsigned long bytes_after_return;
+    XWindowAttributes xwa;
+    Window w;
     
     if (client == NULL)
         return;
-    if (client->colormap_windows != NULL)
-        XFree(client->colormap_windows);
+    forget_windows(client, True);
     if (XGetWindowProperty(dpy, client->window, WM_COLORMAP_WINDOWS, 0,
-                           sizeof(Window), False, XA_WINDOW,
+                           MAX_COLORMAP_WINDOWS, False, XA_WINDOW,
                            &actual, &fmt, &client->ncolormap_windows,
                            &bytes_after_return,
-                           (void *)&client->colormap_windows) == 0) {
-        if (client->colormap_windows != NULL)
-            XFree(client->colormap_windows);
+                           (void *)&client->colormap_windows) != Success) {
+        client->colormap_windows = NULL;
         client->ncolormap_windows = 0;
         return;
     }
-    if (fmt != 32 || actual != XA_ATOM) {
+    if (fmt != 32 || actual != XA_WINDOW || client->ncolormap_windows == 0) {
         if (client->colormap_windows != NULL)
             XFree(client->colormap_windows);
+        client->colormap_windows = NULL;
         client->ncolormap_windows = 0;
+        return;
+    }
+    debug(("\tClient %s is using WM_COLORMAP_WINDOWS\n", client_dbg(client)));
+
+    client->colormap_window_maps =
+        Malloc(client->ncolormap_windows * sizeof(Colormap));
+    if (client->colormap_window_maps == NULL) {
+        perror("AHWM: colormap_update_windows_property: malloc");
+        XFree(client->colormap_windows);
+        client->colormap_windows = NULL;
+        client->ncolormap_windows = 0;
+        return;
+    }
+    for (i = 0; i < client->ncolormap_windows; i++) {
+        w = client->colormap_windows[i];
+        client->colormap_window_maps[i] = None;
+        if (w == client->window) continue;
+        /* select first so we can't miss a change */
+        XSelectInput(dpy, w, ColormapChangeMask);
+        if (XGetWindowAttributes(dpy, w, &xwa) != 0)
+            client->colormap_window_maps[i] = xwa.colormap;
+        XSaveContext(dpy, w, colormap_context, (void *)client);
+    }
+    if (client == focus_current)
+        colormap_install(client);
+}
+
+Bool colormap_handle_notify(XColormapEvent *xevent)
+{
+    client_t *client;
+    int i;
+
+    if (XFindContext(dpy, xevent->window, colormap_context,
+                     (void *)&client) != 0) {
+        return False;
+    }
+    if (xevent->new == False)
+        return True;
+    for (i = 0; i < client->ncolormap_windows; i++) {
+        if (client->colormap_windows[i] == xevent->window)
+            client->colormap_window_maps[i] = xevent->colormap;
     }
-    fprintf(stderr, "Client %s is using WM_COLORMAP_WINDOWS\n",
-            client->name);
     if (client == focus_current)
         colormap_install(client);
+    return True;
+}
+
+void colormap_forget(client_t *client)
+{
+    forget_windows(client, False);
 }
 
 Bool colormap_handle_clientmessage(XClientMessageEvent *xevent)
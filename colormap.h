@@ -44,6 +44,12 @@ extern Atom WM_COLORMAP_WINDOWS;
 
 void colormap_init();
 
+/*
+ * Declare our atoms with atoms_declare()
+ */
+
+void colormap_declare_atoms();
+
 /*
  * Install the client's colormaps.
  */
@@ -57,6 +63,21 @@ void colormap_install(client_t *client);
 
 void colormap_update_windows_property(client_t *client);
 
+/*
+ * Handle a ColormapNotify on one of the windows listed in some
+ * client's WM_COLORMAP_WINDOWS.  Returns False if the window isn't
+ * one of those.
+ */
+
+Bool colormap_handle_notify(XColormapEvent *xevent);
+
+/*
+ * Stop tracking a client's colormap windows; call when the client
+ * is destroyed.
+ */
+
+void colormap_forget(client_t *client);
+
 /*
  * Try to handle a ClientMessage.  Returns True if handled it.
  */
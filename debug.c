@@ -46,3 +46,15 @@ void _debug(char *fmt, ...)
 }
 # endif
 #endif
+
+void report_stderr(char *fmt, ...)
+{
+#ifdef HAVE_VPRINTF
+    va_list ap;
+
+    fprintf(stderr, "AHWM: ");
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+#endif
+}
@@ -47,4 +47,15 @@ void _debug(char *fmt, ...);
 #define debug(x) _debug x
 
 #endif /* DEBUG */
+
+/*
+ * Statistics (see pool.c and malloc.c) are written through one of
+ * these, so the same code can write them to stderr or down the
+ * control socket.
+ */
+
+typedef void (*report_fn)(char *fmt, ...);
+
+void report_stderr(char *fmt, ...);
+
 #endif /* DEBUG_H */
@@ -205,6 +205,8 @@ char *default_ahwmrc[] = {
 "# The height of the titlebar is determined by the font you choose.",
 "# If you would like a larger font, I might suggest this one:",
 "# TitlebarFont = \"-adobe-times-*-r-*-*-*-180-*-*-*-*-*-*\";",
+"# Or, for antialiased titles if AHWM was built with Xft:",
+"# TitlebarFont = \"xft:Sans-10:bold\";",
 "",
 "# NumberOfWorkspaces is special in that it cannot be put into a",
 "# context like all the other options (it only applies globally)",
@@ -349,6 +351,8 @@ char *default_ahwmrc[] = {
 "#",
 "# AlwaysOnBottom (boolean)          - below all other clients?",
 "# AlwaysOnTop (boolean)             - on top of all other clients?",
+"# AnimationFrameRate (integer)      - frames per second, only global",
+"# AnimationLength (integer)         - milliseconds, zero for none, only global",
 "# ColorTitlebar (string)            - an X color, ie \"#FF0000\" or \"red\"",
 "# ColorTitlebarFocused (string)     - titlebar color when window is focused",
 "# ColorTitlebarText (string)        - color of window's title",
@@ -361,11 +365,13 @@ char *default_ahwmrc[] = {
 "# DontBindKeys (boolean)            - do not apply key bindings",
 "# FocusPolicy (enumeration)         - one of:",
 "#             { ClickToFocus, SloppyFocus, DontFocus }",
+"# FocusSettleTime (integer)         - milliseconds before SloppyFocus, only global",
 "# KeepTransientsOnTop (boolean)     - app's dialogs stay on top of app?",
 "# NumberOfWorkspaces (integer)      - must be > 0, only global",
 "# Omnipresent (boolean)             - display in all workspaces?",
 "# PassFocusClick (boolean)          - pass focusing click for ClickToFocus?",
 "# RaiseDelay (integer)              - milliseconds before raise with SloppyFocus",
+"# RoundTripBudget (integer)         - X replies a handler may wait for, only global",
 "# Sticky (boolean)                  - do not allow moving or resizing",
 "# TitlebarFont (string)             - X font name, only global",
 "# TitlePosition (enumeration)       - one of:",
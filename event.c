@@ -28,11 +28,23 @@
 #include <X11/Xatom.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
 #include <errno.h>
 #include <stdlib.h>
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H) \
+    && defined(HAVE_SYS_SIGNALFD_H) && defined(HAVE_CLOCK_GETTIME)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#endif
+
 #include "ahwm.h"
 #include "event.h"
 #include "client.h"
@@ -51,6 +63,14 @@
 #include "colormap.h"
 #include "ewmh.h"
 #include "timer.h"
+#include "kill.h"
+#include "snapshot.h"
+#include "pool.h"
+#include "flight.h"
+#include "trace.h"
+#include "xstats.h"
+#include "latency.h"
+#include "record.h"
 
 #ifdef SHAPE
 #include <X11/extensions/shape.h>
@@ -73,6 +93,9 @@ static void event_map(XMapEvent *);
 static void event_reparentnotify(XReparentEvent *);
 static void configure_nonclient(XConfigureRequestEvent *xevent);
 static void raise_on_timeout(timer *t, void *v);
+static void focus_on_enter(client_t *client);
+static void settle_on_timeout(timer *t, void *v);
+static void settle_commit();
 
 #ifdef SHAPE
 static void event_shape(XShapeEvent *);
@@ -117,31 +140,324 @@ static unsigned int ignore_enternotify_hack = 0;
 static void update_ignore_enternotify_hack(XEvent *event);
 static Time figure_timestamp(XEvent *event);
 
+/*
+ * The main loop waits on the X connection, the timers, the signals
+ * we care about and any other file descriptors some module has asked
+ * us to watch.  Where we have epoll, the timers are represented by a
+ * timerfd and signals by a signalfd, so everything comes through one
+ * epoll_wait() and nothing has to be rebuilt on each iteration.
+ * Elsewhere we fall back to select() and a self-pipe for signals.
+ * 
+ * Signals are only ever acted upon from the loop, never from a
+ * handler, so Xlib is never reentered.  If AHWM is truly hung and
+ * can't get back to the loop, SIGTERM won't help, but SIGKILL will.
+ */
+
+typedef struct _watch {
+    int fd;
+    event_fd_fn fn;
+    void *arg;
+} watch;
+
+static watch *watches = NULL;
+static int nwatches = 0;
+static int nwatches_allocated = 0;
+
+static int event_xfd = -1;
+
+#ifdef USE_EPOLL
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static struct timeval timer_fd_armed; /* zero if disarmed */
+#else
+static int signal_pipe[2] = { -1, -1 };
+#endif
+
+static void event_signal(int signo);
+static void event_run_watch(int fd);
+#ifdef USE_EPOLL
+static void event_arm_timer_fd();
+static void event_read_signal_fd(int fd, void *ignored);
+#else
+static void event_signal_handler(int signo);
+static void event_read_signal_pipe(int fd, void *ignored);
+#endif
+
+void event_init(int xfd)
+{
+    sigset_t set;
+#ifdef USE_EPOLL
+    struct epoll_event ev;
+    int fd;
+#else
+    struct sigaction sa;
+#endif
+
+    event_xfd = xfd;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGHUP);
+    sigaddset(&set, SIGUSR1);
+
+#ifdef USE_EPOLL
+    epoll_fd = epoll_create(8);
+    if (epoll_fd < 0) {
+        perror("AHWM: epoll_create");
+        exit(1);
+    }
+    fcntl(epoll_fd, F_SETFD, FD_CLOEXEC);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = xfd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, xfd, &ev) < 0) {
+        perror("AHWM: epoll_ctl");
+        exit(1);
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (timer_fd < 0) {
+        perror("AHWM: timerfd_create");
+        exit(1);
+    }
+    fcntl(timer_fd, F_SETFD, FD_CLOEXEC);
+    ev.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+
+    /* signals we read from the signalfd must be blocked */
+    sigprocmask(SIG_BLOCK, &set, NULL);
+    fd = signalfd(-1, &set, 0);
+    if (fd < 0) {
+        perror("AHWM: signalfd");
+        exit(1);
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    event_watch_fd(fd, event_read_signal_fd, NULL);
+#else
+    if (pipe(signal_pipe) < 0) {
+        perror("AHWM: pipe");
+        exit(1);
+    }
+    fcntl(signal_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(signal_pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(signal_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(signal_pipe[1], F_SETFL, O_NONBLOCK);
+    event_watch_fd(signal_pipe[0], event_read_signal_pipe, NULL);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = event_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGCHLD, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
+}
+
+int event_watch_fd(int fd, event_fd_fn fn, void *arg)
+{
+    watch *tmp;
+#ifdef USE_EPOLL
+    struct epoll_event ev;
+#endif
+
+    if (nwatches == nwatches_allocated) {
+        tmp = Realloc(watches, (nwatches_allocated + 4) * sizeof(watch));
+        if (tmp == NULL) {
+            return -1;
+        }
+        watches = tmp;
+        nwatches_allocated += 4;
+    }
+#ifdef USE_EPOLL
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("AHWM: epoll_ctl");
+        return -1;
+    }
+#endif
+    watches[nwatches].fd = fd;
+    watches[nwatches].fn = fn;
+    watches[nwatches].arg = arg;
+    nwatches++;
+    return 0;
+}
+
+void event_unwatch_fd(int fd)
+{
+    int i;
+
+    for (i = 0; i < nwatches; i++) {
+        if (watches[i].fd == fd) {
+#ifdef USE_EPOLL
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+#endif
+            watches[i] = watches[--nwatches];
+            return;
+        }
+    }
+}
+
+static void event_run_watch(int fd)
+{
+    int i;
+
+    for (i = 0; i < nwatches; i++) {
+        if (watches[i].fd == fd) {
+            (watches[i].fn)(fd, watches[i].arg);
+            return;
+        }
+    }
+}
+
+/*
+ * Act on a signal from the event loop.  SIGCHLD reaps every child
+ * that has exited, SIGTERM exits (running atexit() functions, which
+ * the default action wouldn't), SIGHUP restarts and thus rereads the
+ * configuration file, SIGUSR1 writes our statistics to stderr.
+ */
+
+static void event_signal(int signo)
+{
+    switch (signo) {
+        case SIGCHLD:
+            while (waitpid(-1, NULL, WNOHANG) > 0)
+                ;
+            break;
+        case SIGTERM:
+            ahwm_quit(NULL, NULL);
+            break;
+        case SIGHUP:
+            ahwm_restart(NULL, NULL);
+            break;
+        case SIGUSR1:
+            pool_report(report_stderr);
+            malloc_report(report_stderr);
+            xstats_report(report_stderr);
+            latency_report(report_stderr);
+            break;
+    }
+}
+
+#ifdef USE_EPOLL
+
+void event_get(int xfd, XEvent *event)
+{
+    struct epoll_event evs[8];
+    int i, n;
+
+    for (;;) {
+        event_arm_timer_fd();
+        if (XPending(dpy) > 0) {
+            XNextEvent(dpy, event);
+            record_event(event);
+            event_timestamp = figure_timestamp(event);
+            return;
+        }
+        /* end of a batch: everything queued has been handled */
+        snapshot_commit();
+        record_flush();
+        n = epoll_wait(epoll_fd, evs, sizeof(evs) / sizeof(evs[0]), -1);
+        if (n < 0) {
+            if (errno != EINTR) perror("AHWM: epoll_wait");
+            continue;
+        }
+        for (i = 0; i < n; i++) {
+            if (evs[i].data.fd == xfd) {
+                continue;       /* XPending() will read it */
+            } else if (evs[i].data.fd == timer_fd) {
+                unsigned long long expirations;
+                read(timer_fd, &expirations, sizeof(expirations));
+                timer_fd_armed.tv_sec = timer_fd_armed.tv_usec = 0;
+            } else {
+                event_run_watch(evs[i].data.fd);
+            }
+        }
+    }
+}
+
+/*
+ * Run any timers that are due and point the timerfd at the next one.
+ * The timerfd is only touched when the earliest deadline changes.
+ */
+
+static void event_arm_timer_fd()
+{
+    struct timeval next;
+    struct itimerspec its;
+
+    if (timer_next_deadline(&next) == 0) {
+        next.tv_sec = next.tv_usec = 0;
+    }
+    if (next.tv_sec == timer_fd_armed.tv_sec
+        && next.tv_usec == timer_fd_armed.tv_usec) {
+        return;
+    }
+    /* an all-zero it_value disarms */
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = next.tv_sec;
+    its.it_value.tv_nsec = next.tv_usec * 1000;
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        perror("AHWM: timerfd_settime");
+        return;
+    }
+    timer_fd_armed = next;
+}
+
+static void event_read_signal_fd(int fd, void *ignored)
+{
+    struct signalfd_siginfo info;
+
+    /* one at a time; epoll tells us again if there are more */
+    if (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        event_signal(info.ssi_signo);
+    }
+}
+
+#else /* !USE_EPOLL */
+
 void event_get(int xfd, XEvent *event)
 {
     fd_set fds;
     struct timeval tv;
     struct timeval *timeout;
-    int have_timeout;
+    int have_timeout, maxfd, i;
 
     /* timeout "fork" at v. 1.73 */
     for (;;) {
         have_timeout = timer_next_time(&tv);
         if (XPending(dpy) > 0) {
             XNextEvent(dpy, event);
+            record_event(event);
             event_timestamp = figure_timestamp(event);
             return;
         }
+        snapshot_commit();
+        record_flush();
         FD_ZERO(&fds);
         FD_SET(xfd, &fds);
+        maxfd = xfd;
+        for (i = 0; i < nwatches; i++) {
+            FD_SET(watches[i].fd, &fds);
+            if (watches[i].fd > maxfd) maxfd = watches[i].fd;
+        }
         if (have_timeout) {
             timeout = &tv;
         } else {
             timeout = NULL;
         }
-        if (select(xfd + 1, &fds, NULL, NULL, timeout) > 0) {
+        if ( (i = select(maxfd + 1, &fds, NULL, NULL, timeout)) > 0) {
+            for (i = 0; i <= maxfd; i++) {
+                if (i != xfd && FD_ISSET(i, &fds)) {
+                    event_run_watch(i);
+                }
+            }
             continue;
-        } else if (errno != EINTR) {
+        } else if (i == 0 || errno != EINTR) {
             if (timeout != NULL) {
                 timer_run_first();
             } else {
@@ -151,57 +467,45 @@ void event_get(int xfd, XEvent *event)
     }
 }
 
+static void event_signal_handler(int signo)
+{
+    unsigned char c = signo;
+    int saved_errno = errno;
+
+    write(signal_pipe[1], &c, 1);
+    errno = saved_errno;
+}
+
+static void event_read_signal_pipe(int fd, void *ignored)
+{
+    unsigned char c;
+
+    while (read(fd, &c, 1) == 1) {
+        event_signal(c);
+    }
+}
+
+#endif /* USE_EPOLL */
+
 void event_dispatch(XEvent *event)
 {
+    flight_record *fr;
+    xstats_frame xf;
+
 #ifdef DEBUG
-    static char *xevent_names[] = {
-        /* event name */        /* Do we handle it? */
-        "Zero",                 /* NO */
-        "One",                  /* NO */
-        "KeyPress",             /* YES */
-        "KeyRelease",           /* YES */
-        "ButtonPress",          /* YES */
-        "ButtonRelease",        /* YES */
-        "MotionNotify",         /* YES */
-        "EnterNotify",          /* YES */
-        "LeaveNotify",          /* YES */
-        "FocusIn",              /* TODO */
-        "FocusOut",             /* TODO */
-        "KeymapNotify",         /* TODO */
-        "Expose",               /* YES */
-        "GraphicsExpose",       /* NO? */
-        "NoExpose",             /* NO? */
-        "VisibilityNotify",     /* TODO */
-        "CreateNotify",         /* YES */
-        "DestroyNotify",        /* YES */
-        "UnmapNotify",          /* YES */
-        "MapNotify",            /* YES */
-        "MapRequest",           /* YES */
-        "ReparentNotify",       /* YES */
-        "ConfigureNotify",      /* TODO */
-        "ConfigureRequest",     /* YES */
-        "GravityNotify",        /* TODO */
-        "ResizeRequest",        /* TODO */
-        "CirculateNotify",      /* TODO */
-        "CirculateRequest",     /* YES */
-        "PropertyNotify",       /* YES */
-        "SelectionClear",       /* NO */
-        "SelectionRequest",     /* NO */
-        "SelectionNotify",      /* NO */
-        "ColormapNotify",       /* YES */
-        "ClientMessage",        /* YES */
-        "MappingNotify",        /* TODO */
-    };
-    
     debug(("----------------------------------------"));
     debug(("----------------------------------------\n"));
-    if (event->type > MappingNotify)
+    if (xev_name(event->type) == NULL)
         debug(("%-19s unknown (%d)\n", "received event:", event->type));
     else
         debug(("%-19s %s (%d)\n", "received event:",
-               xevent_names[event->type], event->type));
+               xev_name(event->type), event->type));
     xev_print(event);
 #endif /* DEBUG */
+
+    fr = flight_log(FLIGHT_EVENT, event->type, event_window(event), 0);
+    TRACE2(event_start, event->type, event_window(event));
+    xstats_enter(&xf, event->type);
     
     /* check the event number, jump to appropriate function */
     switch(event->type) {
@@ -213,12 +517,14 @@ void event_dispatch(XEvent *event)
             
         case KeyPress:          /* XGrabKeys in keyboard.c */
         case KeyRelease:        /* XGrabKeys in keyboard.c */
+            if (event->type == KeyPress) settle_commit();
             keyboard_handle_event(&event->xkey);
             break;
             
         case ButtonPress:       /* XGrabButton in mouse.c */
         case ButtonRelease:     /* XGrabButton in mouse.c */
         case MotionNotify:      /* XGrabButton in mouse.c */
+            if (event->type == ButtonPress) settle_commit();
             mouse_handle_event(event);
             break;
             
@@ -318,13 +624,35 @@ void event_dispatch(XEvent *event)
             debug(("\tIgnoring event\n"));
             break;
     }
+    xstats_leave(&xf);
+    flight_done(fr);
+    latency_event(event, event->xany.send_event
+                  ? CurrentTime : figure_timestamp(event), fr);
+    TRACE2(event_end, event->type, event_window(event));
 }
 
+/*
+ * The raise timer is created once and rearmed on every EnterNotify.
+ * We remember the window rather than the client, since the client
+ * may have gone away by the time the timer shoots.
+ */
+
+static timer *raise_timer = NULL;
+static Window raise_window = None;
+
+/* pending SloppyFocus target, see settle_commit() */
+static timer *settle_timer = NULL;
+static Window settle_window = None;
+static Window settle_focused = None; /* focus when it was chosen */
+
 static void raise_on_timeout(timer *t, void *v)
 {
-    client_t *client = (client_t *)v;
-    stacking_raise(client);
-    /* call timer_cancel in event_enter() next time around */
+    client_t *client;
+
+    client = client_find(raise_window);
+    if (client != NULL) {
+        stacking_raise(client);
+    }
 }
 
 /*
@@ -349,7 +677,6 @@ static void raise_on_timeout(timer *t, void *v)
 static void event_enter(XCrossingEvent *xevent)
 {
     client_t *client;
-    static timer *t = NULL;
     
     if (xevent->mode != NotifyNormal) {
         debug(("\tMode != NotifyNormal, ignoring event\n"));
@@ -370,21 +697,80 @@ static void event_enter(XCrossingEvent *xevent)
     if (client != NULL && client->state == NormalState
         && xevent->serial != ignore_enternotify_hack
         && client->focus_policy == SloppyFocus) {
-        
-        debug(("\tSetting focus in response to EnterNotify\n"));
-        focus_set(client, CurrentTime);
-        if (client->raise_delay == 0) {
-            stacking_raise(client);
+
+        if (focus_settle_time == 0) {
+            focus_on_enter(client);
+            return;
+        }
+        debug(("\tFocusing %s once the pointer settles\n",
+               client_dbg(client)));
+        settle_window = client->window;
+        settle_focused = focus_current ? focus_current->window : None;
+        if (settle_timer == NULL) {
+            settle_timer = timer_new(focus_settle_time,
+                                     settle_on_timeout, NULL);
         } else {
-            if (t != NULL) timer_cancel(t);
-            t = timer_new(client->raise_delay, raise_on_timeout,
-                          (void *)client);
+            timer_rearm(settle_timer, focus_settle_time);
         }
     } else {
         debug(("\tNot setting focus\n"));
     }
 }
 
+static void focus_on_enter(client_t *client)
+{
+    debug(("\tSetting focus in response to EnterNotify\n"));
+    focus_set(client, CurrentTime);
+    if (client->raise_delay == 0) {
+        if (raise_timer != NULL) timer_disarm(raise_timer);
+        stacking_raise(client);
+    } else {
+        raise_window = client->window;
+        if (raise_timer == NULL) {
+            raise_timer = timer_new(client->raise_delay,
+                                    raise_on_timeout, NULL);
+        } else {
+            timer_rearm(raise_timer, client->raise_delay);
+        }
+    }
+}
+
+/*
+ * With FocusSettleTime set, sweeping the pointer across windows only
+ * remembers the window it entered last.  Focusing it, with all that
+ * entails (XSetInputFocus, titlebars, button grabs, colormaps,
+ * _NET_ACTIVE_WINDOW, the raise timer), happens once, when the
+ * pointer has stayed there that long.  A key or button press that
+ * reaches us, which means one of our bindings, commits the pending
+ * focus at once, so the binding acts on the window the user means;
+ * presses we don't grab go to the old focus until the timer fires.  As with raise_window, we remember the window and
+ * look the client up again, in case it goes away meanwhile.  If the
+ * focus has been moved some other way since the pointer entered (a
+ * new window, a pager's _NET_ACTIVE_WINDOW, the control socket), the
+ * pending focus is stale and is dropped.
+ */
+
+static void settle_on_timeout(timer *t, void *v)
+{
+    settle_commit();
+}
+
+static void settle_commit()
+{
+    client_t *client;
+
+    if (settle_window == None) return;
+    client = client_find(settle_window);
+    settle_window = None;
+    if (settle_timer != NULL) timer_disarm(settle_timer);
+    if (client != NULL && client->state == NormalState
+        && client->focus_policy == SloppyFocus
+        && client->workspace == workspace_current
+        && settle_focused == (focus_current ? focus_current->window : None)) {
+        focus_on_enter(client);
+    }
+}
+
 /*
  * remove client structure
  */
@@ -806,18 +1192,15 @@ static void event_property(XPropertyEvent *xevent)
 
     client = client_find(xevent->window);
     if (client == NULL) return;
-    if (xevent->atom == XA_WM_NAME) {
+    if (xevent->atom == XA_WM_NAME || xevent->atom == _NET_WM_NAME) {
         /* move-resize.c takes over client->name while
          * moving or resizing and then resets value */
         if (moving || sizing) return;
         debug(("\tWM_NAME, changing client->name\n"));
-        Free(client->name);
         client_set_name(client);
         paint_titlebar(client);
     } else if (xevent->atom == XA_WM_CLASS) {
         debug(("\tWM_CLASS, changing client->[class, instance]\n"));
-        if (client->class != None) XFree(client->class);
-        if (client->instance != None) XFree(client->instance);
         client_set_instance_class(client);
     } else if (xevent->atom == XA_WM_HINTS) {
         debug(("\tWM_HINTS, changing client->xwmh\n"));
@@ -852,6 +1235,8 @@ static void event_colormap(XColormapEvent *xevent)
 {
     client_t *client;
     
+    if (colormap_handle_notify(xevent))
+        return;
     if (xevent->new == True) {
         client = client_find(xevent->window);
         if (client != NULL) {
@@ -892,7 +1277,7 @@ static void event_clientmessage(XClientMessageEvent *xevent)
 			client_inform_state(client);
 			focus_add(client, event_timestamp);
 		}
-    } else {
+    } else if (kill_handle_pong(xevent) == False) {
         if (ewmh_handle_clientmessage(xevent) == False) {
             colormap_handle_clientmessage(xevent);
         }
@@ -910,16 +1295,27 @@ static void event_circulaterequest(XCirculateRequestEvent *xevent)
  * repaint the whole thing at once.
  */
 
+/*
+ * Exposes come in series, one event per rectangle, with count
+ * telling how many more follow for the same window.  Collect the
+ * rectangles and repaint once at the end of the series.
+ */
+
 static void event_expose(XExposeEvent *xevent)
 {
     client_t *client;
+    XRectangle r;
 
-    /* simple, stupid */
-    if (xevent->count != 0) return;
-    
     client = client_find(xevent->window);
-    if (client != NULL)
-        paint_titlebar(client);
+    if (client == NULL || xevent->window != client->titlebar) return;
+
+    r.x = xevent->x;
+    r.y = xevent->y;
+    r.width = xevent->width;
+    r.height = xevent->height;
+    paint_titlebar_damage(client, &r);
+    if (xevent->count == 0)
+        paint_titlebar_repair(client);
 }
 
 /*
@@ -36,9 +36,39 @@
 
 extern Time event_timestamp;
 
+/*
+ * Functions called when a watched file descriptor becomes readable.
+ */
+
+typedef void (*event_fd_fn)(int fd, void *arg);
+
+/*
+ * Set up the main loop:  XFD is the X connection.  Also takes over
+ * SIGCHLD (children are reaped automatically), SIGTERM (exit cleanly)
+ * and SIGHUP (restart).  Those signals may be blocked when this
+ * returns, so unblock them in any child process before exec().
+ * Depends on timer_init().
+ */
+
+void event_init(int xfd);
+
+/*
+ * Have event_get() call FN with FD and ARG whenever FD is readable.
+ * Returns -1 on failure.
+ */
+
+int event_watch_fd(int fd, event_fd_fn fn, void *arg);
+
+/*
+ * Stop watching a file descriptor; call before closing it.
+ */
+
+void event_unwatch_fd(int fd);
+
 /*
  * Get an event from the event queue, place it into EVENT.  XFD is a
- * file descriptor which points to the X connection.
+ * file descriptor which points to the X connection.  Timers and
+ * watched file descriptors are serviced while waiting.
  */
 
 void event_get(int xfd, XEvent *event);
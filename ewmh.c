@@ -33,6 +33,7 @@
 #include "compat.h"
 #include "ahwm.h"
 #include "ewmh.h"
+#include "atoms.h"
 #include "malloc.h"
 #include "debug.h"
 #include "focus.h"
@@ -46,7 +47,7 @@
  * 
  * - use _NET_WORKAREA for move/resize/placement
  * - _NET_WM_STRUT:  recalculate _NET_WORKAREA
- * - _NET_WM_PING, _NET_WM_PID
+ * x _NET_WM_PING, _NET_WM_PID
  * - some properties must be updated on window if set by ahwm:
  *   x _NET_WM_DESKTOP
  *   - _NET_WM_STATE
@@ -91,14 +92,14 @@
  * "hints."
  */
 
-#define NO_SUPPORTED_HINTS 33
+#define NO_SUPPORTED_HINTS 34
 
 static Atom _NET_CURRENT_DESKTOP, _NET_SUPPORTED, _NET_CLIENT_LIST;
 static Atom _NET_CLIENT_LIST_STACKING, _NET_NUMBER_OF_DESKTOPS;
 static Atom _NET_DESKTOP_GEOMETRY, _NET_DESKTOP_VIEWPORT;
 static Atom _NET_ACTIVE_WINDOW, _NET_WORKAREA, _NET_SUPPORTING_WM_CHECK;
 static Atom _NET_DESKTOP_NAMES;
-static Atom _NET_CLOSE_WINDOW, _NET_WM_MOVERESIZE, _NET_WM_NAME;
+static Atom _NET_CLOSE_WINDOW, _NET_WM_MOVERESIZE;
 static Atom _NET_WM_WINDOW_TYPE_DESKTOP;
 static Atom _NET_WM_WINDOW_TYPE_DOCK, _NET_WM_WINDOW_TYPE_TOOLBAR;
 static Atom _NET_WM_WINDOW_TYPE_MENU, _NET_WM_WINDOW_TYPE_DIALOG;
@@ -108,9 +109,10 @@ static Atom _NET_WM_STATE_MAXIMIZED_VERT, _NET_WM_STATE_MAXIMIZED_HORZ;
 static Atom _NET_WM_STATE_SHADED, _NET_WM_STATE_SKIP_TASKBAR;
 static Atom _NET_WM_STATE_SKIP_PAGER, _NET_WM_STATE_REMOVE;
 static Atom _NET_WM_STATE_ADD, _NET_WM_STATE_TOGGLE;
-static Atom _NET_WM_PING, _NET_WM_STATE_STAYS_ON_TOP;
+static Atom _NET_WM_STATE_STAYS_ON_TOP;
 
 Atom _NET_WM_STRUT, _NET_WM_STATE, _NET_WM_WINDOW_TYPE, _NET_WM_DESKTOP;
+Atom _NET_WM_NAME, _NET_WM_PING;
 
 /* EWMH 1.1 claims this is supposed to be "UTF-8_STRING" (which
  * is a perfectly good atom identifier), but it's actually
@@ -139,6 +141,49 @@ void ewmh_to_menu(client_t *client);
 void ewmh_to_toolbar(client_t *client);
 Bool ewmh_handle_clientmessage(XClientMessageEvent *xevent);
 
+void ewmh_declare_atoms()
+{
+    atoms_declare(&_NET_CURRENT_DESKTOP, "_NET_CURRENT_DESKTOP");
+    atoms_declare(&_NET_SUPPORTED, "_NET_SUPPORTED");
+    atoms_declare(&_NET_CLIENT_LIST, "_NET_CLIENT_LIST");
+    atoms_declare(&_NET_CLIENT_LIST_STACKING, "_NET_CLIENT_LIST_STACKING");
+    atoms_declare(&_NET_NUMBER_OF_DESKTOPS, "_NET_NUMBER_OF_DESKTOPS");
+    atoms_declare(&_NET_DESKTOP_GEOMETRY, "_NET_DESKTOP_GEOMETRY");
+    atoms_declare(&_NET_DESKTOP_VIEWPORT, "_NET_DESKTOP_VIEWPORT");
+    atoms_declare(&_NET_ACTIVE_WINDOW, "_NET_ACTIVE_WINDOW");
+    atoms_declare(&_NET_WORKAREA, "_NET_WORKAREA");
+    atoms_declare(&_NET_SUPPORTING_WM_CHECK, "_NET_SUPPORTING_WM_CHECK");
+    atoms_declare(&_NET_CLOSE_WINDOW, "_NET_CLOSE_WINDOW");
+    atoms_declare(&_NET_WM_MOVERESIZE, "_NET_WM_MOVERESIZE");
+    atoms_declare(&_NET_WM_NAME, "_NET_WM_NAME");
+    atoms_declare(&_NET_WM_DESKTOP, "_NET_WM_DESKTOP");
+    atoms_declare(&_NET_WM_WINDOW_TYPE, "_NET_WM_WINDOW_TYPE");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_DESKTOP, "_NET_WM_WINDOW_TYPE_DESKTOP");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_DOCK, "_NET_WM_WINDOW_TYPE_DOCK");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_TOOLBAR, "_NET_WM_WINDOW_TYPE_TOOLBAR");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_MENU, "_NET_WM_WINDOW_TYPE_MENU");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_DIALOG, "_NET_WM_WINDOW_TYPE_DIALOG");
+    atoms_declare(&_NET_WM_WINDOW_TYPE_NORMAL, "_NET_WM_WINDOW_TYPE_NORMAL");
+    atoms_declare(&_NET_WM_STATE, "_NET_WM_STATE");
+    atoms_declare(&_NET_WM_STATE_MODAL, "_NET_WM_STATE_MODAL");
+    atoms_declare(&_NET_WM_STATE_STICKY, "_NET_WM_STATE_STICKY");
+    atoms_declare(&_NET_WM_STATE_MAXIMIZED_VERT,
+                  "_NET_WM_STATE_MAXIMIZED_VERT");
+    atoms_declare(&_NET_WM_STATE_MAXIMIZED_HORZ,
+                  "_NET_WM_STATE_MAXIMIZED_HORZ");
+    atoms_declare(&_NET_WM_STATE_SHADED, "_NET_WM_STATE_SHADED");
+    atoms_declare(&_NET_WM_STATE_SKIP_TASKBAR, "_NET_WM_STATE_SKIP_TASKBAR");
+    atoms_declare(&_NET_WM_STATE_SKIP_PAGER, "_NET_WM_STATE_SKIP_PAGER");
+    atoms_declare(&_NET_WM_STATE_REMOVE, "_NET_WM_STATE_REMOVE");
+    atoms_declare(&_NET_WM_STATE_ADD, "_NET_WM_STATE_ADD");
+    atoms_declare(&_NET_WM_STATE_TOGGLE, "_NET_WM_STATE_TOGGLE");
+    atoms_declare(&_NET_WM_STRUT, "_NET_WM_STRUT");
+    atoms_declare(&_NET_WM_PING, "_NET_WM_PING");
+    atoms_declare(&UTF8_STRING, "UTF8_STRING");
+    atoms_declare(&_NET_DESKTOP_NAMES, "_NET_DESKTOP_NAMES");
+    atoms_declare(&_NET_WM_STATE_STAYS_ON_TOP, "_NET_WM_STATE_STAYS_ON_TOP");
+}
+
 void ewmh_init()
 {
     unsigned long *l, *l2, bytes_after_return, nitems;
@@ -154,59 +199,6 @@ void ewmh_init()
         fprintf(stderr, "AHWM: this is a fatal error, quitting.\n");
         exit(1);
     }
-    _NET_CURRENT_DESKTOP = XInternAtom(dpy, "_NET_CURRENT_DESKTOP", False);
-    _NET_SUPPORTED = XInternAtom(dpy, "_NET_SUPPORTED", False);
-    _NET_CLIENT_LIST = XInternAtom(dpy, "_NET_CLIENT_LIST", False);
-    _NET_CLIENT_LIST_STACKING =
-        XInternAtom(dpy, "_NET_CLIENT_LIST_STACKING", False);
-    _NET_NUMBER_OF_DESKTOPS =
-        XInternAtom(dpy, "_NET_NUMBER_OF_DESKTOPS", False);
-    _NET_DESKTOP_GEOMETRY = XInternAtom(dpy, "_NET_DESKTOP_GEOMETRY", False);
-    _NET_DESKTOP_VIEWPORT = XInternAtom(dpy, "_NET_DESKTOP_VIEWPORT", False);
-    _NET_ACTIVE_WINDOW = XInternAtom(dpy, "_NET_ACTIVE_WINDOW", False);
-    _NET_WORKAREA = XInternAtom(dpy, "_NET_WORKAREA", False);
-    _NET_SUPPORTING_WM_CHECK =
-        XInternAtom(dpy, "_NET_SUPPORTING_WM_CHECK", False);
-    _NET_CLOSE_WINDOW = XInternAtom(dpy, "_NET_CLOSE_WINDOW", False);
-    _NET_WM_MOVERESIZE = XInternAtom(dpy, "_NET_WM_MOVERESIZE", False);
-    _NET_WM_NAME = XInternAtom(dpy, "_NET_WM_NAME", False);
-    _NET_WM_DESKTOP = XInternAtom(dpy, "_NET_WM_DESKTOP", False);
-    _NET_WM_WINDOW_TYPE = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", False);
-    _NET_WM_WINDOW_TYPE_DESKTOP =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DESKTOP", False);
-    _NET_WM_WINDOW_TYPE_DOCK =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DOCK", False);
-    _NET_WM_WINDOW_TYPE_TOOLBAR =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_TOOLBAR", False);
-    _NET_WM_WINDOW_TYPE_MENU =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_MENU", False);
-    _NET_WM_WINDOW_TYPE_DIALOG =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DIALOG", False);
-    _NET_WM_WINDOW_TYPE_NORMAL =
-        XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_NORMAL", False);
-    _NET_WM_STATE = XInternAtom(dpy, "_NET_WM_STATE", False);
-    _NET_WM_STATE_MODAL = XInternAtom(dpy, "_NET_WM_STATE_MODAL", False);
-    _NET_WM_STATE_STICKY = XInternAtom(dpy, "_NET_WM_STATE_STICKY", False);
-    _NET_WM_STATE_MAXIMIZED_VERT =
-        XInternAtom(dpy, "_NET_WM_STATE_MAXIMIZED_VERT", False);
-    _NET_WM_STATE_MAXIMIZED_HORZ =
-        XInternAtom(dpy, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
-    _NET_WM_STATE_SHADED = XInternAtom(dpy, "_NET_WM_STATE_SHADED", False);
-    _NET_WM_STATE_SKIP_TASKBAR =
-        XInternAtom(dpy, "_NET_WM_STATE_SKIP_TASKBAR", False);
-    _NET_WM_STATE_SKIP_PAGER =
-        XInternAtom(dpy, "_NET_WM_STATE_SKIP_PAGER", False);
-    _NET_WM_STATE_REMOVE = XInternAtom(dpy, "_NET_WM_STATE_REMOVE", False);
-    _NET_WM_STATE_ADD = XInternAtom(dpy, "_NET_WM_STATE_ADD", False);
-    _NET_WM_STATE_TOGGLE = XInternAtom(dpy, "_NET_WM_STATE_TOGGLE", False);
-    _NET_WM_STRUT = XInternAtom(dpy, "_NET_WM_STRUT", False);
-    _NET_WM_PING = XInternAtom(dpy, "_NET_WM_PING", False);
-    UTF8_STRING = XInternAtom(dpy, "UTF8_STRING", False);
-    _NET_DESKTOP_NAMES = XInternAtom(dpy, "_NET_DESKTOP_NAMES", False);
-    _NET_WM_WINDOW_TYPE = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", False);
-    _NET_WM_STATE = XInternAtom(dpy, "_NET_WM_STATE", False);
-    _NET_WM_STATE_STAYS_ON_TOP =
-        XInternAtom(dpy, "_NET_WM_STATE_STAYS_ON_TOP", False);
 
     supported[0] = _NET_SUPPORTED;
     supported[1] = _NET_CLIENT_LIST;
@@ -241,8 +233,8 @@ void ewmh_init()
     supported[30] = _NET_WM_STATE_ADD;
     supported[31] = _NET_WM_STATE_TOGGLE;
     supported[32] = _NET_DESKTOP_NAMES;
-    /* supported[33] = _NET_WM_STRUT; */
-    /* supported[34] = _NET_WM_PING; */
+    supported[33] = _NET_WM_PING;
+    /* supported[34] = _NET_WM_STRUT; */
 
     XChangeProperty(dpy, root_window, _NET_SUPPORTED,
                     XA_ATOM, 32, PropModeReplace,
@@ -608,6 +600,42 @@ void ewmh_wm_desktop_apply(client_t *client)
     if (ws != NULL) XFree(ws);
 }
 
+/*
+ * Titles longer than this many bytes are cut off; they wouldn't fit
+ * on the titlebar anyway.
+ */
+
+#define MAX_NAME_LENGTH 4096
+
+char *ewmh_get_wm_name(client_t *client)
+{
+    Atom actual;
+    int fmt;
+    unsigned long bytes_after_return, nitems;
+    unsigned char *data;
+    char *name;
+
+    data = NULL;
+    if (XGetWindowProperty(dpy, client->window, _NET_WM_NAME, 0,
+                           MAX_NAME_LENGTH / 4, False, UTF8_STRING,
+                           &actual, &fmt, &nitems, &bytes_after_return,
+                           (void *)&data) != Success) {
+        debug(("\tXGetWindowProperty(_NET_WM_NAME) failed\n"));
+        return NULL;
+    }
+    if (nitems == 0 || fmt != 8 || actual != UTF8_STRING) {
+        if (data != NULL) XFree(data);
+        return NULL;
+    }
+    name = Malloc(nitems + 1);
+    if (name != NULL) {
+        memcpy(name, data, nitems);
+        name[nitems] = '\0';
+    }
+    XFree(data);
+    return name;
+}
+
 /*
  * EWMH does not specify how the application can change
  * _NET_WINDOW_TYPE.  We will assume the application can change this
@@ -49,10 +49,17 @@
 
 /* These are needed by event.c: */
 extern Atom _NET_WM_WINDOW_TYPE, _NET_WM_STATE, _NET_WM_STRUT, _NET_WM_DESKTOP;
+extern Atom _NET_WM_NAME, _NET_WM_PING;
 
 /*
- * initialize module, getting atoms and setting root properties
- * Depends on number of workspaces being set
+ * Declare our atoms with atoms_declare()
+ */
+
+void ewmh_declare_atoms();
+
+/*
+ * initialize module, setting root properties
+ * Depends on number of workspaces being set and atoms_intern()
  */
 
 void ewmh_init();
@@ -91,4 +98,7 @@ void ewmh_wm_state_apply(client_t *client);
 void ewmh_window_type_apply(client_t *client);
 void ewmh_wm_desktop_apply(client_t *client);
 
+/* returns the client's UTF-8 _NET_WM_NAME, or NULL if not set; Free() it */
+char *ewmh_get_wm_name(client_t *client);
+
 #endif /* EWMH_H */
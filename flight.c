@@ -0,0 +1,118 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include "flight.h"
+#include "timer.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 1024
+#endif
+
+static flight_record ring[FLIGHT_RECORDS];
+static unsigned long total = 0;
+static char path[PATH_MAX];
+
+void flight_init()
+{
+    char *s;
+
+    s = getenv("AHWM_FLIGHT");
+    if (s != NULL && *s != '\0') {
+        snprintf(path, sizeof(path), "%s", s);
+        return;
+    }
+    s = getenv("HOME");
+    if (s == NULL) s = "/";
+    snprintf(path, sizeof(path), "%s/.ahwm-flight", s);
+}
+
+flight_record *flight_log(int kind, int detail, Window w, unsigned long arg)
+{
+    flight_record *r;
+    struct timeval tv;
+
+    timer_now(&tv);
+    r = &ring[total++ & (FLIGHT_RECORDS - 1)];
+    r->sec = tv.tv_sec;
+    r->usec = tv.tv_usec;
+    r->window = w;
+    r->arg = arg;
+    r->kind = kind;
+    r->detail = detail;
+    return r;
+}
+
+void flight_done(flight_record *r)
+{
+    struct timeval tv;
+
+    timer_now(&tv);
+    r->arg = (tv.tv_sec - r->sec) * 1000000 + tv.tv_usec - r->usec;
+}
+
+/* write(2) until done; false on error */
+static int write_all(int fd, char *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+        n = write(fd, buf, len);
+        if (n <= 0) return 0;
+        buf += n;
+        len -= n;
+    }
+    return 1;
+}
+
+char *flight_dump(char *file)
+{
+    flight_header h;
+    int fd, ok;
+
+    if (file == NULL) file = path;
+    if (file[0] == '\0') return NULL;
+    fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return NULL;
+    h.magic = FLIGHT_MAGIC;
+    h.version = FLIGHT_VERSION;
+    h.record_size = sizeof(flight_record);
+    h.nrecords = FLIGHT_RECORDS;
+    h.total = total;
+    ok = write_all(fd, (char *)&h, sizeof(h))
+        && write_all(fd, (char *)ring, sizeof(ring));
+    close(fd);
+    return ok ? file : NULL;
+}
@@ -0,0 +1,107 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef FLIGHT_H
+#define FLIGHT_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xmd.h>
+
+/*
+ * The flight recorder keeps the last few thousand things we did in a
+ * ring of small binary records, so that when AHWM crashes or gets
+ * confused outside a DEBUG build there is something to look at.
+ * Logging a record is a couple of stores and a clock read; nothing is
+ * formatted until somebody decodes a dump with ahwm-flight.
+ * 
+ * The ring is written to a file when we get SIGSEGV or SIGBUS (before
+ * the crash dialog comes up) and by the control socket's "flight"
+ * command.  The file is AHWM_FLIGHT if that is set in the
+ * environment, otherwise ~/.ahwm-flight.
+ * 
+ * A dump is a flight_header followed by 'nrecords' flight_records in
+ * ring order; if 'total' is at least 'nrecords' the ring has wrapped
+ * and the oldest record is at index total % nrecords.  Everything is
+ * in native byte order.  Times come from the monotonic clock, so only
+ * differences between them mean anything.
+ */
+
+#define FLIGHT_MAGIC   0x52464841 /* "AHFR" on little-endian machines */
+#define FLIGHT_VERSION 1
+#define FLIGHT_RECORDS 4096     /* a power of two */
+
+/* record kinds */
+#define FLIGHT_EVENT   1        /* detail: event type; arg: usecs spent */
+#define FLIGHT_FOCUS   2        /* window given the input focus; arg: time */
+#define FLIGHT_RAISE   3        /* client raised; arg: clients above it */
+#define FLIGHT_RESTACK 4        /* client restacked; arg: clients above it */
+
+typedef struct _flight_header {
+    CARD32 magic;
+    CARD32 version;
+    CARD32 record_size;         /* sizeof(flight_record) */
+    CARD32 nrecords;            /* size of the ring */
+    CARD32 total;               /* records ever logged */
+} flight_header;
+
+typedef struct _flight_record {
+    CARD32 sec, usec;           /* when it happened */
+    CARD32 window;
+    CARD32 arg;
+    CARD16 kind;
+    CARD16 detail;
+} flight_record;
+
+/*
+ * Choose the dump file.  No dependencies.
+ */
+
+void flight_init();
+
+/*
+ * Add a record.  The record returned stays in the ring until
+ * FLIGHT_RECORDS more have been logged, so it can be finished later;
+ * that is how event_dispatch() fills in the time spent.
+ */
+
+flight_record *flight_log(int kind, int detail, Window w, unsigned long arg);
+
+/*
+ * Store the microseconds since RECORD was logged as its 'arg'.
+ */
+
+void flight_done(flight_record *record);
+
+/*
+ * Write the ring to FILE, or to the dump file if FILE is NULL.  Uses
+ * only open(2) and write(2), so this may be called from a signal
+ * handler.  Returns the file written or NULL on error.
+ */
+
+char *flight_dump(char *file);
+
+#endif /* FLIGHT_H */
@@ -0,0 +1,139 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "client.h"
+#include "focus-core.h"
+
+void focus_ring_insert(focus_node *node, focus_node *old)
+{
+    if (old == NULL) {
+        node->next = node;
+        node->prev = node;
+    } else {
+        node->next = old;
+        node->prev = old->prev;
+        old->prev->next = node;
+        old->prev = node;
+    }
+}
+
+focus_node *focus_ring_remove(focus_node *node)
+{
+    focus_node *new;
+
+    if (node->next == node) {
+        node->next = NULL;
+        node->prev = NULL;
+        return NULL;
+    }
+    new = focus_ring_next(node);
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    return new;
+}
+
+focus_node *focus_ring_prev(focus_node *node)
+{
+    focus_node *p;
+
+    for (p = node->prev; p != node; p = p->prev) {
+        if (!(p->client->cycle_behaviour == SkipCycle
+              || p->client->focus_policy == DontFocus))
+            return p;
+    }
+    return node->prev;
+}
+
+focus_node *focus_ring_next(focus_node *node)
+{
+    focus_node *p;
+
+    for (p = node->next; p != node; p = p->next) {
+        if (!(p->client->cycle_behaviour == SkipCycle
+              || p->client->focus_policy == DontFocus))
+            return p;
+    }
+    return node->next;
+}
+
+/*
+ * This will swap two elements in the focus stack, moving one to the
+ * top of the stack.
+ * 
+ * ring looks like this:
+ * A-B-...-C-D-E-...-F-A
+ * and we want it to look like this:
+ * D-A-B-...-C-E-...-F-D
+ * 
+ * special cases:
+ * A-A-...  ->  A-A-...  (no change)
+ * A-B-A-...  ->  B-A-B-... (no change, just update focus_current)
+ * A-D-E-...-F-A  ->  D-A-E-...-F-D  (just swap A & D)
+ * A-B-...-C-D-A  ->  D-A-B-...-C-D  (no change, just update focus_current)
+ * We actually don't change B in any way, so it's left out.
+ */
+
+void focus_ring_permute(focus_node *A, focus_node *D)
+{
+    focus_node *C, *E, *F;
+
+    if (A->client->workspace != D->client->workspace)
+        return;
+    
+    /* if have only one or two elements, or not moving, done */
+    if (A == D || (A->next == D && D->next == A))
+        return;
+
+    F = A->prev;
+    C = D->prev;
+    E = D->next;
+
+    if (A->next == D) {
+        /* no B or C, just swap A & D */
+        A->prev = D;
+        D->next = A;
+        
+        A->next = E;
+        E->prev = A;
+        
+        F->next = D;
+        D->prev = F;
+        
+    } else if (A->prev == D) {
+        /* no E or F, no need for change */
+    } else {
+        /* B and D are separated by at least one node on each side */
+        C->next = E;
+        E->prev = C;
+
+        F->next = D;
+        D->prev = F;
+
+        D->next = A;
+        A->prev = D;
+    }
+}
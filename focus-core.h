@@ -0,0 +1,77 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The focus stacks (see focus.c) are rings of nodes, most recently
+ * focused first.  These are the operations on the rings themselves;
+ * nothing here talks to the X server, so they can be run and timed
+ * without one.
+ */
+
+#ifndef FOCUS_CORE_H
+#define FOCUS_CORE_H
+
+#include "config.h"
+
+#include "client.h"
+
+typedef struct _focus_node {
+    struct _focus_node *next;
+    struct _focus_node *prev;
+    client_t *client;
+} focus_node;
+
+/*
+ * Link NODE into a ring just before OLD, which is where the most
+ * recently focused node goes.  If OLD is NULL, NODE makes a ring of
+ * its own.
+ */
+
+void focus_ring_insert(focus_node *node, focus_node *old);
+
+/*
+ * Unlink NODE from its ring.  Returns the node which should be
+ * focused if NODE was, or NULL if NODE was the only one.
+ */
+
+focus_node *focus_ring_remove(focus_node *node);
+
+/*
+ * Move D just in front of A, where A is the node at the top of the
+ * stack; see focus-core.c.
+ */
+
+void focus_ring_permute(focus_node *A, focus_node *D);
+
+/*
+ * The nodes before and after NODE which Alt-Tab should stop on,
+ * skipping windows which are not focused by cycling.  If there are
+ * none, these return the neighbouring node regardless.
+ */
+
+focus_node *focus_ring_prev(focus_node *node);
+focus_node *focus_ring_next(focus_node *node);
+
+#endif /* FOCUS_CORE_H */
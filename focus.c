@@ -62,6 +62,8 @@
 #include <stdio.h>
 #include "compat.h"
 #include "focus.h"
+#include "focus-core.h"
+#include "atoms.h"
 #include "client.h"
 #include "workspace.h"
 #include "debug.h"
@@ -70,15 +72,13 @@
 #include "keyboard-mouse.h"
 #include "stacking.h"
 #include "malloc.h"
+#include "pool.h"
 #include "paint.h"
 #include "colormap.h"
+#include "flight.h"
+#include "trace.h"
 
-typedef struct _focus_node {
-    struct _focus_node *next;
-    struct _focus_node *prev;
-    client_t *client;
-} focus_node;
-
+int focus_settle_time = 0;
 client_t *focus_current = NULL;
 
 Window focus_revert_window = None;
@@ -87,18 +87,35 @@ static focus_node **focus_stacks;
 
 static XContext *focus_contexts;
 
+/* _AHWM_FOCUS_NODES_n for each workspace, see focus_save_stacks() */
+static Atom *focus_nodes_atoms;
+
 static Bool in_alt_tab = False; /* see focus_alt_tab, focus_ensure */
 
 static focus_node *find_node(client_t *);
 static void focus_change_current(client_t *, Time, Bool, Bool);
 static void focus_set_internal(focus_node *, Time, Bool, Bool);
-static void permute(focus_node *, focus_node *);
-static focus_node *get_prev(focus_node *);
-static focus_node *get_next(focus_node *);
 static void focus_add_internal(focus_node *, int ws, Time timestamp);
 static void focus_remove_internal(focus_node *, int ws, Time timestamp);
 static void cycle_helper(focus_node *node);
 
+void focus_declare_atoms()
+{
+    char buf[32];
+    int ws;
+
+    focus_nodes_atoms = malloc(nworkspaces * sizeof(Atom));
+    if (focus_nodes_atoms == NULL) {
+        perror("AHWM: focus_declare_atoms: malloc");
+        fprintf(stderr, "AHWM: this is a fatal error, quitting.\n");
+        exit(1);
+    }
+    for (ws = 0; ws < nworkspaces; ws++) {
+        snprintf(buf, 32, "_AHWM_FOCUS_NODES_%d", ws);
+        atoms_declare(&focus_nodes_atoms[ws], buf);
+    }
+}
+
 void focus_init()
 {
     int i;
@@ -180,18 +197,19 @@ void focus_add(client_t *client, Time timestamp)
     if ( (node = find_node(client)) != NULL)
         focus_remove(client, CurrentTime);
     if (client->omnipresent) {
-        node = Malloc(nworkspaces * sizeof(focus_node));
-        if (node == NULL) {
-            fprintf(stderr, "AHWM: out of memory while focusing client\n");
-            return;
-        }
-        debug(("\tOmnipresent node = %#lx\n", node));
+        /* one node per workspace, each freed on its own */
         for (i = 0; i < nworkspaces; i++) {
-            node[i].client = client;
-            focus_add_internal(&node[i], i + 1, timestamp);
+            node = pool_alloc(sizeof(focus_node));
+            if (node == NULL) {
+                fprintf(stderr, "AHWM: out of memory while focusing client\n");
+                return;
+            }
+            debug(("\tOmnipresent node = %#lx\n", node));
+            node->client = client;
+            focus_add_internal(node, i + 1, timestamp);
         }
     } else {
-        node = Malloc(sizeof(focus_node));
+        node = pool_alloc(sizeof(focus_node));
         if (node == NULL) {
             fprintf(stderr, "AHWM: out of memory while focusing client\n");
             return;
@@ -206,18 +224,10 @@ static void focus_add_internal(focus_node *node, int ws, Time timestamp)
     focus_node *old;
 
     old = focus_stacks[ws - 1];
-    if (old == NULL) {
-        node->next = node;
-        node->prev = node;
-    } else {
-        node->next = old;
-        node->prev = old->prev;
-        old->prev->next = node;
-        old->prev = node;
-    }
+    focus_ring_insert(node, old);
     if (node->client->focus_policy == DontFocus) {
         if (old != NULL)
-            permute(node, old);
+            focus_ring_permute(node, old);
         if (node->next == node)
             focus_stacks[ws - 1] = node;
     } else {
@@ -256,36 +266,32 @@ void focus_remove(client_t *client, Time timestamp)
             }
             debug(("\tOmnipresent, i = %d, node = 0x%lx\n\n", i, node));
             focus_remove_internal(node, i + 1, timestamp);
+            pool_free(node, sizeof(focus_node));
         }
     } else {
         node = find_node(client);
         if (node == NULL) return;
         focus_remove_internal(node, client->workspace, timestamp);
+        pool_free(node, sizeof(focus_node));
     }
-    if (node != NULL) Free(node);
 }
 
 static void focus_remove_internal(focus_node *node, int ws, Time timestamp)
 {
     focus_node *new;
 
-    new = get_next(node);
-    
     /* remove from list */
-    node->prev->next = node->next;
-    node->next->prev = node->prev;
+    new = focus_ring_remove(node);
     /* if was focused for workspace, update workspace pointer */
-    if (focus_stacks[ws - 1] == node) {
+    if (focus_stacks[ws - 1] == node && new != NULL) {
         debug(("\tSetting focus stack of workspace %d to %s\n",
                ws, client_dbg(new->client)));
         focus_stacks[ws - 1] = new;
     }
     /* if only client left on workspace, set to NULL */
-    if (node->next == node) {
+    if (new == NULL) {
         debug(("\tSetting focus stack of workspace %d to null\n", ws));
         focus_stacks[ws - 1] = NULL;
-        node->next = NULL;
-        node->prev = NULL;
     }
     /* if removed focused window, refocus now */
     if (node->client == focus_current && ws == workspace_current) {
@@ -316,7 +322,7 @@ void focus_set(client_t *client, Time timestamp)
     old = find_node(focus_current);
     focus_set_internal(node, timestamp, True, True);
     if (old != NULL && node != NULL)
-        permute(old, node);
+        focus_ring_permute(old, node);
 }
 
 /*
@@ -380,12 +386,14 @@ static void focus_set_internal(focus_node *node, Time timestamp,
 void focus_ensure(Time timestamp)
 {
     if (focus_current == NULL || focus_current->focus_policy == DontFocus) {
+        flight_log(FLIGHT_FOCUS, 0, focus_revert_window, CurrentTime);
         XSetInputFocus(dpy, focus_revert_window,
                        RevertToPointerRoot, CurrentTime);
         return;
     }
 
     debug(("\tCalling XSetInputFocus %s\n", client_dbg(focus_current)));
+    flight_log(FLIGHT_FOCUS, 0, focus_current->window, timestamp);
 
     ewmh_active_window_update();
 
@@ -427,6 +435,8 @@ static void focus_change_current(client_t *new, Time timestamp,
 
     old = focus_current;
     focus_current = new;
+    TRACE3(focus_change, old != NULL ? old->window : None,
+           new != NULL ? new->window : None, timestamp);
     paint_titlebar(old);
     paint_titlebar(new);
     if (new != NULL && new->focus_policy == DontFocus) return;
@@ -528,11 +538,11 @@ void focus_cycle_next(XEvent *xevent, arglist *ignored)
                 fn = keyboard_find_function(&xevent->xkey, NULL);
                 if (fn == focus_cycle_next) {
                     node = focus_stacks[workspace_current - 1];
-                    node = get_next(node);
+                    node = focus_ring_next(node);
                     cycle_helper(node);
                 } else if (fn == focus_cycle_prev) {
                     node = focus_stacks[workspace_current - 1];
-                    node = get_prev(node);
+                    node = focus_ring_prev(node);
                     cycle_helper(node);
                 } else {
                     state = REPLAY_KEYBOARD;
@@ -624,7 +634,7 @@ void focus_cycle_next(XEvent *xevent, arglist *ignored)
     
     node = focus_stacks[workspace_current - 1];
     if (state != QUIT && node != NULL && orig_focus != NULL) {
-        permute(orig_focus, node);
+        focus_ring_permute(orig_focus, node);
     }
                     
     if (state == REPLAY_KEYBOARD) {
@@ -652,88 +662,6 @@ static void cycle_helper(focus_node *node)
     }
 }
 
-static focus_node *get_prev(focus_node *node)
-{
-    focus_node *p;
-
-    for (p = node->prev; p != node; p = p->prev) {
-        if (!(p->client->cycle_behaviour == SkipCycle
-              || p->client->focus_policy == DontFocus))
-            return p;
-    }
-    return node->prev;
-}
-
-static focus_node *get_next(focus_node *node)
-{
-    focus_node *p;
-
-    for (p = node->next; p != node; p = p->next) {
-        if (!(p->client->cycle_behaviour == SkipCycle
-              || p->client->focus_policy == DontFocus))
-            return p;
-    }
-    return node->next;
-}
-
-/*
- * This will swap two elements in the focus stack, moving one to the
- * top of the stack.
- * 
- * ring looks like this:
- * A-B-...-C-D-E-...-F-A
- * and we want it to look like this:
- * D-A-B-...-C-E-...-F-D
- * 
- * special cases:
- * A-A-...  ->  A-A-...  (no change)
- * A-B-A-...  ->  B-A-B-... (no change, just update focus_current)
- * A-D-E-...-F-A  ->  D-A-E-...-F-D  (just swap A & D)
- * A-B-...-C-D-A  ->  D-A-B-...-C-D  (no change, just update focus_current)
- * We actually don't change B in any way, so it's left out.
- */
-
-static void permute(focus_node *A, focus_node *D)
-{
-    focus_node *C, *E, *F;
-
-    if (A->client->workspace != D->client->workspace)
-        return;
-    
-    /* if have only one or two elements, or not moving, done */
-    if (A == D || (A->next == D && D->next == A))
-        return;
-
-    F = A->prev;
-    C = D->prev;
-    E = D->next;
-
-    if (A->next == D) {
-        /* no B or C, just swap A & D */
-        A->prev = D;
-        D->next = A;
-        
-        A->next = E;
-        E->prev = A;
-        
-        F->next = D;
-        D->prev = F;
-        
-    } else if (A->prev == D) {
-        /* no E or F, no need for change */
-    } else {
-        /* B and D are separated by at least one node on each side */
-        C->next = E;
-        E->prev = C;
-
-        F->next = D;
-        D->prev = F;
-
-        D->next = A;
-        A->prev = D;
-    }
-}
-
 void focus_debug()
 {
     int ws;
@@ -756,16 +684,13 @@ void focus_save_stacks()
 {
     int ws;
     focus_node *orig, *node;
-    Atom atom;
-    char buf[32];
 
     for (ws = 0; ws < nworkspaces; ws++) {
-        snprintf(buf, 32, "_AHWM_FOCUS_NODES_%d", ws);
-        atom = XInternAtom(dpy, buf, False);
         if (focus_stacks[ws] == NULL) continue;
         node = orig = focus_stacks[ws]->prev;
         do {
-            XChangeProperty(dpy, root_window, atom, XA_WINDOW, 32,
+            XChangeProperty(dpy, root_window, focus_nodes_atoms[ws],
+                            XA_WINDOW, 32,
                             node == orig ? PropModeReplace : PropModeAppend,
                             (void *)&node->client->window, 1);
             node = node->prev;
@@ -780,18 +705,15 @@ void focus_load_stacks()
     Window *windows;
     focus_node *node;
     client_t *client;
-    Atom atom, actual;
-    char buf[32];
+    Atom actual;
 
     debug(("focus_load_stacks\n"));
     for (ws = 0; ws < nworkspaces; ws++) {
-        snprintf(buf, 32, "_AHWM_FOCUS_NODES_%d", ws);
-        atom = XInternAtom(dpy, buf, False);
-        if (XGetWindowProperty(dpy, root_window, atom, 0,
+        if (XGetWindowProperty(dpy, root_window, focus_nodes_atoms[ws], 0,
                                0x7FFFFFFF, False, XA_WINDOW, &actual,
                                &fmt, &nitems, &bytes_after_return,
                                (void *)&windows) != Success) {
-            debug(("XGetWindowProperty(%s) failed\n", buf));
+            debug(("XGetWindowProperty(_AHWM_FOCUS_NODES_%d) failed\n", ws));
             continue;
         }
         if (actual != XA_WINDOW || fmt != 32) {
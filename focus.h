@@ -48,6 +48,20 @@ extern client_t *focus_current;
 
 extern Window focus_revert_window;
 
+/*
+ * Milliseconds the pointer must rest in a SloppyFocus window before
+ * it is focused; zero focuses at once.  Set by prefs.c.
+ */
+
+extern int focus_settle_time;
+
+/*
+ * Declare an atom per workspace for focus_save_stacks() with
+ * atoms_declare().  Depends on number of workspaces being set
+ */
+
+void focus_declare_atoms();
+
 /*
  * Initialize the focus module
  * Depends on number of workspaces being set
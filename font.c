@@ -0,0 +1,218 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+
+#ifdef HAVE_XFT
+#include <X11/Xft/Xft.h>
+#endif
+
+#include "font.h"
+#include "ahwm.h"
+#include "client.h"
+#include "paint.h"
+#include "malloc.h"
+#include "debug.h"
+
+#define XFT_PREFIX "xft:"
+
+/* used for the geometry display when the title font is not a core font */
+#define FALLBACK_FONT "fixed"
+
+Bool font_utf8 = False;
+
+static XFontStruct *load_core(char *name);
+
+#ifdef HAVE_XFT
+
+static XftFont *xft_font = NULL;
+static XftDraw *xft_draw = NULL;
+
+/*
+ * Xft wants a full XRenderColor rather than a pixel; we only ever
+ * use a handful of colors, so remember the ones we've looked up.
+ */
+
+typedef struct _xft_color {
+    unsigned long pixel;
+    XftColor color;
+} xft_color;
+
+static xft_color *xft_colors = NULL;
+static int nxft_colors = 0;
+
+static XftColor *lookup_color(unsigned long pixel);
+
+#endif /* HAVE_XFT */
+
+void font_init(char *name)
+{
+#ifdef HAVE_XFT
+    if (strncmp(name, XFT_PREFIX, sizeof(XFT_PREFIX) - 1) == 0) {
+        xft_font = XftFontOpenName(dpy, scr, name + sizeof(XFT_PREFIX) - 1);
+        if (xft_font == NULL) {
+            fprintf(stderr, "AHWM: Could not load font \"%s\".  "
+                    "Using default font instead.\n", name);
+        } else {
+            font_utf8 = True;
+            TITLE_HEIGHT = xft_font->ascent + xft_font->descent;
+            paint_ascent = xft_font->ascent;
+            fontstruct = load_core(FALLBACK_FONT);
+            return;
+        }
+        name = FALLBACK_FONT;
+    }
+#endif /* HAVE_XFT */
+
+    fontstruct = load_core(name);
+    TITLE_HEIGHT = fontstruct->max_bounds.ascent + fontstruct->max_bounds.descent;
+    paint_ascent = fontstruct->max_bounds.ascent;
+}
+
+static XFontStruct *load_core(char *name)
+{
+    XFontStruct *fs;
+
+    fs = XLoadQueryFont(dpy, name);
+    if (fs == NULL) {
+        fprintf(stderr, "AHWM: Could not load font \"%s\".  "
+                "Using default font instead.\n", name);
+        /* now this font name should never fail */
+        fs = XLoadQueryFont(dpy, "-*-*-*-*-*-*-*-*-*-*-*-*-*-*");
+        if (fs == NULL) {
+            /* Could not load any fonts.  Might happen if user uses
+             * and misconfigures font server or something.  Might try
+             * to continue without titlebars. */
+            fprintf(stderr, "AHWM: Could not load any fonts at all.\n");
+            fprintf(stderr, "AHWM: This is a fatal error - quitting.\n");
+            exit(1);
+        }
+    }
+    return fs;
+}
+
+int font_width(char *s, int len)
+{
+#ifdef HAVE_XFT
+    XGlyphInfo extents;
+
+    if (xft_font != NULL) {
+        XftTextExtentsUtf8(dpy, xft_font, (FcChar8 *)s, len, &extents);
+        return extents.xOff;
+    }
+#endif /* HAVE_XFT */
+    return XTextWidth(fontstruct, s, len);
+}
+
+/*
+ * Binary search on the byte length.  Widths only grow as we add
+ * bytes (Xft stops measuring at an incomplete character), and
+ * measuring is done on the client side by both Xlib and Xft, so this
+ * is a handful of cheap calls.
+ */
+
+int font_fit(char *s, int len, int room, int *width)
+{
+    int lo, hi, mid;
+
+    lo = 0;
+    hi = len;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (font_width(s, mid) <= room)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    /* don't cut a UTF-8 sequence in half */
+    if (font_utf8) {
+        while (lo > 0 && lo < len && (s[lo] & 0xC0) == 0x80)
+            lo--;
+    }
+    *width = font_width(s, lo);
+    return lo;
+}
+
+void font_draw(Drawable d, GC gc, unsigned long fg,
+               int x, int y, char *s, int len)
+{
+#ifdef HAVE_XFT
+    XftColor *color;
+
+    if (xft_font != NULL) {
+        color = lookup_color(fg);
+        if (color == NULL) return;
+        if (xft_draw == NULL) {
+            xft_draw = XftDrawCreate(dpy, d, DefaultVisual(dpy, scr),
+                                     DefaultColormap(dpy, scr));
+            if (xft_draw == NULL) return;
+        } else {
+            XftDrawChange(xft_draw, d);
+        }
+        XftDrawStringUtf8(xft_draw, color, xft_font, x, y, (FcChar8 *)s, len);
+        return;
+    }
+#endif /* HAVE_XFT */
+    XDrawString(dpy, d, gc, x, y, s, len);
+}
+
+#ifdef HAVE_XFT
+
+static XftColor *lookup_color(unsigned long pixel)
+{
+    int i;
+    xft_color *tmp;
+    XColor xc;
+
+    for (i = 0; i < nxft_colors; i++) {
+        if (xft_colors[i].pixel == pixel)
+            return &xft_colors[i].color;
+    }
+
+    tmp = Realloc(xft_colors, (nxft_colors + 1) * sizeof(xft_color));
+    if (tmp == NULL) {
+        perror("AHWM: font_draw: realloc");
+        return NULL;
+    }
+    xft_colors = tmp;
+
+    xc.pixel = pixel;
+    XQueryColor(dpy, DefaultColormap(dpy, scr), &xc);
+    tmp = &xft_colors[nxft_colors++];
+    tmp->pixel = pixel;
+    tmp->color.pixel = pixel;
+    tmp->color.color.red = xc.red;
+    tmp->color.color.green = xc.green;
+    tmp->color.color.blue = xc.blue;
+    tmp->color.color.alpha = 0xFFFF;
+    return &tmp->color;
+}
+
+#endif /* HAVE_XFT */
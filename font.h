@@ -0,0 +1,84 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Titlebar text.  The title font is normally a core X font, but if
+ * ahwm was built with Xft and the font name starts with "xft:", the
+ * rest of the name is handed to Xft and titles are drawn
+ * antialiased through the Render extension.  Xft keeps its own
+ * cache of rendered glyphs on the server, so drawing a title only
+ * sends glyph indices.
+ *
+ * Window titles are stored in the font's encoding: UTF-8 for Xft
+ * fonts (taken from _NET_WM_NAME when the client sets it) and the
+ * encoding of WM_NAME for core fonts.
+ */
+
+#ifndef FONT_H
+#define FONT_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+
+/*
+ * True if titles are in UTF-8.
+ */
+
+extern Bool font_utf8;
+
+/*
+ * Loads the title font, falling back to any core font available.
+ * Sets TITLE_HEIGHT, paint_ascent and fontstruct (which is always a
+ * core font, used for the geometry display while moving and
+ * resizing).  Exits if no font at all can be loaded.
+ */
+
+void font_init(char *name);
+
+/*
+ * Width in pixels of the first LEN bytes of S.
+ */
+
+int font_width(char *s, int len);
+
+/*
+ * Returns how many bytes of S, at most LEN, fit in ROOM pixels,
+ * never splitting a character.  The width of those bytes is stored
+ * in WIDTH.
+ */
+
+int font_fit(char *s, int len, int room, int *width);
+
+/*
+ * Draws the first LEN bytes of S at X, Y (the baseline) in color FG.
+ * GC must have the title font and foreground FG; it is used for core
+ * fonts.
+ */
+
+void font_draw(Drawable d, GC gc, unsigned long fg,
+               int x, int y, char *s, int len);
+
+#endif /* FONT_H */
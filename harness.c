@@ -0,0 +1,271 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "harness.h"
+#include "default-ahwmrc.h"
+
+int harness_errors = 0;
+int harness_bindings = 0;
+
+static pid_t xvfb_pid = -1;
+static pid_t wm_pid = -1;
+static int control_fd = -1;
+static char socket_name[64];
+static char home[64];
+
+static char control_buf[8192];
+static int control_len = 0;
+
+static pid_t spawn(char **argv);
+static int error_handler(Display *dpy, XErrorEvent *e);
+
+Display *harness_start(char *display, unsigned int width,
+                       unsigned int height, char *wm)
+{
+    char geometry[64];
+    char *argv[8];
+    Display *dpy = NULL;
+    int i;
+
+    snprintf(geometry, sizeof(geometry), "%ux%ux24", width, height);
+    argv[0] = "Xvfb";
+    argv[1] = display;
+    argv[2] = "-screen";
+    argv[3] = "0";
+    argv[4] = geometry;
+    argv[5] = "-nolisten";
+    argv[6] = "tcp";
+    argv[7] = NULL;
+    xvfb_pid = spawn(argv);
+    if (xvfb_pid < 0) return NULL;
+    for (i = 0; i < 100; i++) {
+        if ((dpy = XOpenDisplay(display)) != NULL) break;
+        usleep(100000);
+    }
+    if (dpy == NULL) {
+        fprintf(stderr, "could not open display %s\n", display);
+        harness_stop(NULL);
+        return NULL;
+    }
+    XSetErrorHandler(error_handler);
+
+    snprintf(socket_name, sizeof(socket_name), "/tmp/ahwm-harness-%d",
+             (int)getpid());
+    setenv("DISPLAY", display, 1);
+    setenv("AHWM_SOCKET", socket_name, 1);
+    unsetenv("AHWM_RECORD");
+    if (!harness_start_wm(wm)) {
+        harness_stop(dpy);
+        return NULL;
+    }
+    return dpy;
+}
+
+Bool harness_start_wm(char *wm)
+{
+    struct sockaddr_un addr;
+    char *argv[2];
+    int i;
+
+    argv[0] = wm;
+    argv[1] = NULL;
+    wm_pid = spawn(argv);
+    if (wm_pid < 0) return False;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_name, sizeof(addr.sun_path) - 1);
+    for (i = 0; i < 1000; i++) {
+        control_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (control_fd < 0) {
+            perror("socket");
+            break;
+        }
+        if (connect(control_fd, (struct sockaddr *)&addr,
+                    sizeof(addr)) == 0) {
+            control_len = 0;
+            return True;
+        }
+        close(control_fd);
+        control_fd = -1;
+        if (waitpid(wm_pid, NULL, WNOHANG) == wm_pid) {
+            wm_pid = -1;
+            break;
+        }
+        usleep(10000);
+    }
+    fprintf(stderr, "%s never opened its control socket\n", wm);
+    harness_stop_wm();
+    return False;
+}
+
+void harness_stop_wm()
+{
+    if (control_fd >= 0) close(control_fd);
+    control_fd = -1;
+    if (wm_pid > 0) {
+        kill(wm_pid, SIGTERM);
+        waitpid(wm_pid, NULL, 0);
+    }
+    wm_pid = -1;
+    unlink(socket_name);
+}
+
+FILE *harness_home(Bool counting)
+{
+    char file[80];
+    FILE *f;
+    int i;
+
+    strcpy(home, "/tmp/ahwm-harness-XXXXXX");
+    if (mkdtemp(home) == NULL) {
+        perror("mkdtemp");
+        home[0] = '\0';
+        return NULL;
+    }
+    snprintf(file, sizeof(file), "%s/.ahwmrc", home);
+    f = fopen(file, "w");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s\n", file, strerror(errno));
+        rmdir(home);
+        home[0] = '\0';
+        return NULL;
+    }
+    harness_bindings = 0;
+    for (i = 0; i < sizeof(default_ahwmrc) / sizeof(char *); i++) {
+        fprintf(f, "%s\n", default_ahwmrc[i]);
+        if (strncmp(default_ahwmrc[i], "BindKey ", 8) == 0)
+            harness_bindings++;
+    }
+    if (counting) fprintf(f, "RoundTripBudget = 1000000;\n");
+    setenv("HOME", home, 1);
+    return f;
+}
+
+void harness_home_remove()
+{
+    char file[80];
+
+    if (home[0] == '\0') return;
+    snprintf(file, sizeof(file), "%s/.ahwmrc", home);
+    unlink(file);
+    rmdir(home);
+    home[0] = '\0';
+}
+
+void harness_stop(Display *dpy)
+{
+    harness_stop_wm();
+    if (dpy != NULL) XCloseDisplay(dpy);
+    if (xvfb_pid > 0) {
+        kill(xvfb_pid, SIGTERM);
+        waitpid(xvfb_pid, NULL, 0);
+    }
+    xvfb_pid = -1;
+}
+
+int harness_control(char *command, FILE *out)
+{
+    char *line, *nl;
+    int n, lines = 0;
+    Bool ok;
+
+    if (control_fd < 0) return -1;
+    if (write(control_fd, command, strlen(command)) < 0
+        || write(control_fd, "\n", 1) < 0) {
+        perror("control socket");
+        return -1;
+    }
+    for (;;) {
+        line = control_buf;
+        while ((nl = memchr(line, '\n',
+                            control_len - (line - control_buf))) != NULL) {
+            *nl = '\0';
+            if (strcmp(line, "ok") == 0 || strncmp(line, "error", 5) == 0) {
+                ok = (*line == 'o');
+                if (!ok) fprintf(stderr, "%s: %s\n", command, line);
+                control_len -= nl + 1 - control_buf;
+                memmove(control_buf, nl + 1, control_len);
+                return ok ? lines : -1;
+            }
+            if (out != NULL) fprintf(out, "%s\n", line);
+            lines++;
+            line = nl + 1;
+        }
+        control_len -= line - control_buf;
+        memmove(control_buf, line, control_len);
+        if (control_len == sizeof(control_buf)) {
+            /* a line this long is not something we asked for */
+            control_len = 0;
+        }
+        n = read(control_fd, control_buf + control_len,
+                 sizeof(control_buf) - control_len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            fprintf(stderr, "control socket closed\n");
+            close(control_fd);
+            control_fd = -1;
+            return -1;
+        }
+        control_len += n;
+    }
+}
+
+static pid_t spawn(char **argv)
+{
+    pid_t pid;
+
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        fprintf(stderr, "exec %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    return pid;
+}
+
+static int error_handler(Display *dpy, XErrorEvent *e)
+{
+    harness_errors++;
+    return 0;
+}
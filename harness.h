@@ -0,0 +1,97 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <stdio.h>
+
+/*
+ * Running a window manager on a private Xvfb, for ahwm-replay and
+ * ahwm-bench.  This is not part of AHWM itself.
+ * 
+ * The window manager is told to open its control socket (see ipc.h)
+ * at a private path, which is how we know it is up and how we wait
+ * for it to catch up: a command is answered only once everything
+ * that arrived before it has been handled.
+ */
+
+/* X errors on our connections, which are counted and then ignored */
+extern int harness_errors;
+
+/* BindKey lines in the configuration harness_home() wrote */
+extern int harness_bindings;
+
+/*
+ * Point HOME at a new temporary directory holding AHWM's default
+ * configuration, so the window manager never reads the user's own
+ * and results don't depend on it.  If COUNTING, the configuration
+ * sets RoundTripBudget (see xstats.h), high enough never to complain,
+ * so AHWM counts its requests.  Returns the configuration file, still
+ * open for the caller to add to and close, or NULL on failure.
+ * harness_home_remove() removes the directory again.
+ */
+
+FILE *harness_home(Bool counting);
+void harness_home_remove();
+
+/*
+ * Start Xvfb on DISPLAY with a screen of WIDTH by HEIGHT, then start
+ * WM on it.  Returns our first connection to the server, or NULL if
+ * anything failed, in which case everything has been stopped again.
+ * DISPLAY is exported to the environment, so later XOpenDisplay(NULL)
+ * calls open the same server.
+ */
+
+Display *harness_start(char *display, unsigned int width,
+                       unsigned int height, char *wm);
+
+/*
+ * Start or stop just the window manager, leaving the server and its
+ * windows alone.
+ */
+
+Bool harness_start_wm(char *wm);
+void harness_stop_wm();
+
+/*
+ * Stop the window manager and the server and close DPY.
+ */
+
+void harness_stop(Display *dpy);
+
+/*
+ * Send COMMAND (a line without its newline) to the window manager
+ * and wait for the answer, which is copied to OUT if OUT is not
+ * NULL.  Returns the number of lines before the final "ok", or -1 if
+ * the command failed or the window manager went away.
+ */
+
+int harness_control(char *command, FILE *out);
+
+#endif /* HARNESS_H */
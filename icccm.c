@@ -33,6 +33,7 @@
 #include "compat.h"
 #include "ahwm.h"
 #include "icccm.h"
+#include "atoms.h"
 #include "debug.h"
 
 static Window icccm_window = None;
@@ -40,6 +41,16 @@ static Atom WM_Sn, MESSAGE, VERSION;
 
 static void failure(char *);
 
+void icccm_declare_atoms()
+{
+    char buf[16];
+
+    snprintf(buf, 16, "WM_S%d", scr);
+    atoms_declare(&WM_Sn, buf);
+    atoms_declare(&MESSAGE, "MESSAGE");
+    atoms_declare(&VERSION, "VERSION");
+}
+
 void icccm_init()
 {
     XSetWindowAttributes xswa;
@@ -48,10 +59,6 @@ void icccm_init()
     char buf[16];
 
     snprintf(buf, 16, "WM_S%d", scr);
-    
-    WM_Sn = XInternAtom(dpy, buf, False);
-    MESSAGE = XInternAtom(dpy, "MESSAGE", False);
-    VERSION = XInternAtom(dpy, "VERSION", False);
 
     /* no need to grab the server using mechanisms in ICCCM: */
 /*    XGrabServer(dpy); */
@@ -30,10 +30,16 @@
 
 #include <X11/Xlib.h>
 
+/*
+ * Declare our atoms with atoms_declare()
+ */
+
+void icccm_declare_atoms();
+
 /*
  * Set up "WM_Sn" selection for default screen.  This should be called
  * in the initialization phase, after convenience globals are set up
- * but before the root window is selected for events.
+ * and atoms_intern() but before the root window is selected for events.
  */
 
 void icccm_init();
@@ -0,0 +1,568 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The control socket; see ipc.h for the protocol.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+#include <sys/socket.h>
+#include <sys/un.h>
+#define USE_IPC
+#endif
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include "ipc.h"
+#include "ahwm.h"
+#include "client.h"
+#include "event.h"
+#include "focus.h"
+#include "workspace.h"
+#include "stacking.h"
+#include "move-resize.h"
+#include "prefs.h"
+#include "malloc.h"
+#include "pool.h"
+#include "flight.h"
+#include "xstats.h"
+#include "latency.h"
+#include "debug.h"
+#include "compat.h"
+
+#ifdef USE_IPC
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0          /* and hope SIGPIPE is ignored */
+#endif
+
+#define IPC_MAX_CONNECTIONS 16
+#define IPC_LINE_MAX 1024       /* longest command we take */
+
+typedef struct _connection {
+    int fd;                     /* -1 if the slot is free */
+    int len;                    /* bytes of an unfinished command */
+    char buf[IPC_LINE_MAX];
+} connection;
+
+typedef struct _command {
+    char *name;
+    char *(*fn)(char *args);    /* returns NULL or an error */
+} command;
+
+static int listen_fd = -1;
+static pid_t listen_pid;        /* our children mustn't unlink it */
+static struct sockaddr_un addr;
+static char env_buf[sizeof("AHWM_SOCKET=") + sizeof(addr.sun_path)];
+static connection connections[IPC_MAX_CONNECTIONS];
+
+/* the answers to one batch of commands, written back all at once */
+static char *reply_buf = NULL;
+static int reply_len = 0;
+static int reply_size = 0;
+
+static Bool choose_path();
+static void ipc_cleanup();
+static void ipc_accept(int fd, void *ignored);
+static void ipc_read(int fd, void *arg);
+static void ipc_close(connection *c);
+static void ipc_command(char *line);
+static void reply(char *fmt, ...);
+static void reply_string(char *s);
+static char *next_word(char **s);
+static client_t *find_window(char *s, Bool *focused);
+static void fake_event(XEvent *e, client_t *client);
+static Bool reply_window(client_t *client, void *ignored);
+static char *cmd_clients(char *args);
+static char *cmd_workspace(char *args);
+static char *cmd_focus_stack(char *args);
+static char *cmd_focus(char *args);
+static char *cmd_move(char *args);
+static char *cmd_goto(char *args);
+static char *cmd_invoke(char *args);
+static char *cmd_stats(char *args);
+static char *cmd_flight(char *args);
+static char *cmd_requests(char *args);
+static char *cmd_sync(char *args);
+
+static command commands[] = {
+    { "clients", cmd_clients },
+    { "workspace", cmd_workspace },
+    { "focus-stack", cmd_focus_stack },
+    { "focus", cmd_focus },
+    { "move", cmd_move },
+    { "goto", cmd_goto },
+    { "invoke", cmd_invoke },
+    { "stats", cmd_stats },
+    { "flight", cmd_flight },
+    { "requests", cmd_requests },
+    { "sync", cmd_sync },
+};
+
+#define NCOMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+void ipc_init()
+{
+    struct stat st;
+    int i;
+
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        connections[i].fd = -1;
+    }
+    reply_buf = Malloc(4096);
+    if (reply_buf == NULL) {
+        perror("AHWM: ipc_init: malloc");
+        return;
+    }
+    reply_size = 4096;
+
+    if (!choose_path()) return;
+
+    /* a socket left behind by a crash or by the AHWM we replaced on
+     * restart; never remove anything else */
+    if (lstat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(addr.sun_path);
+    }
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("AHWM: socket");
+        return;
+    }
+    fcntl(listen_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(listen_fd, F_SETFL, O_NONBLOCK);
+    addr.sun_family = AF_UNIX;
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listen_fd, 5) < 0
+        || event_watch_fd(listen_fd, ipc_accept, NULL) < 0) {
+        fprintf(stderr, "AHWM: could not create control socket %s: %s\n",
+                addr.sun_path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+    listen_pid = getpid();
+#ifdef HAVE_ATEXIT
+    atexit(ipc_cleanup);
+#endif
+
+    snprintf(env_buf, sizeof(env_buf), "AHWM_SOCKET=%s", addr.sun_path);
+    putenv(env_buf);
+    debug(("\tControl socket is %s\n", addr.sun_path));
+}
+
+/*
+ * AHWM_SOCKET if set, otherwise a socket named after the display in
+ * a directory only we can get into.
+ */
+
+static Bool choose_path()
+{
+    char dir[64], *s;
+    struct stat st;
+
+    s = getenv("AHWM_SOCKET");
+    if (s != NULL && *s != '\0') {
+        if (strlen(s) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "AHWM: AHWM_SOCKET is too long\n");
+            return False;
+        }
+        strcpy(addr.sun_path, s);
+        return True;
+    }
+
+    snprintf(dir, sizeof(dir), "/tmp/ahwm-%d", (int)getuid());
+    if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+        fprintf(stderr, "AHWM: mkdir %s: %s\n", dir, strerror(errno));
+        return False;
+    }
+    if (lstat(dir, &st) < 0 || !S_ISDIR(st.st_mode)
+        || st.st_uid != getuid() || (st.st_mode & 077) != 0) {
+        fprintf(stderr, "AHWM: %s is not private, no control socket\n", dir);
+        return False;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/%s",
+             dir, DisplayString(dpy));
+    for (s = addr.sun_path + strlen(dir) + 1; *s != '\0'; s++) {
+        if (*s == '/') *s = '_';
+    }
+    return True;
+}
+
+static void ipc_cleanup()
+{
+    if (listen_fd >= 0 && getpid() == listen_pid) {
+        unlink(addr.sun_path);
+    }
+}
+
+static void ipc_accept(int fd, void *ignored)
+{
+    int i, conn_fd;
+
+    conn_fd = accept(fd, NULL, NULL);
+    if (conn_fd < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            perror("AHWM: accept");
+        return;
+    }
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd < 0) break;
+    }
+    if (i == IPC_MAX_CONNECTIONS) {
+        debug(("\tToo many control connections, refusing one\n"));
+        close(conn_fd);
+        return;
+    }
+    fcntl(conn_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(conn_fd, F_SETFL, O_NONBLOCK);
+    if (event_watch_fd(conn_fd, ipc_read, &connections[i]) < 0) {
+        close(conn_fd);
+        return;
+    }
+    connections[i].fd = conn_fd;
+    connections[i].len = 0;
+}
+
+static void ipc_close(connection *c)
+{
+    event_unwatch_fd(c->fd);
+    close(c->fd);
+    c->fd = -1;
+    c->len = 0;
+}
+
+/*
+ * Everything that arrived in one read is one batch: we run all the
+ * complete commands and answer them with a single write.  Anything
+ * after the last newline waits for the next read.
+ */
+
+static void ipc_read(int fd, void *arg)
+{
+    connection *c = (connection *)arg;
+    char *line, *nl;
+    int n;
+
+    n = read(fd, c->buf + c->len, sizeof(c->buf) - c->len);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+    if (n <= 0) {
+        ipc_close(c);
+        return;
+    }
+    c->len += n;
+
+    reply_len = 0;
+    line = c->buf;
+    while ((nl = memchr(line, '\n', c->len - (line - c->buf))) != NULL) {
+        *nl = '\0';
+        ipc_command(line);
+        line = nl + 1;
+    }
+    c->len -= line - c->buf;
+    memmove(c->buf, line, c->len);
+    if (c->len == sizeof(c->buf)) {
+        reply("error command too long\n");
+        c->len = 0;
+    }
+
+    /* we won't block for anybody; a client that lets its socket
+     * fill up gets hung up on */
+    if (reply_len > 0
+        && send(fd, reply_buf, reply_len, MSG_NOSIGNAL) != reply_len) {
+        ipc_close(c);
+    }
+}
+
+static void ipc_command(char *line)
+{
+    char *name, *error;
+    int i, len;
+
+    len = strlen(line);
+    while (len > 0 && strchr(" \t\r", line[len - 1]) != NULL) {
+        line[--len] = '\0';
+    }
+    name = next_word(&line);
+    if (name == NULL) return;   /* blank lines are not commands */
+
+    for (i = 0; i < NCOMMANDS; i++) {
+        if (strcmp(commands[i].name, name) == 0) {
+            error = (*commands[i].fn)(line);
+            if (error == NULL) {
+                reply("ok\n");
+            } else {
+                reply("error %s\n", error);
+            }
+            return;
+        }
+    }
+    reply("error unknown command %s\n", name);
+}
+
+static void reply(char *fmt, ...)
+{
+    va_list args;
+    char *tmp;
+    int n;
+
+    for (;;) {
+        va_start(args, fmt);
+        n = vsnprintf(reply_buf + reply_len, reply_size - reply_len,
+                      fmt, args);
+        va_end(args);
+        if (n >= 0 && n < reply_size - reply_len) {
+            reply_len += n;
+            return;
+        }
+        tmp = Realloc(reply_buf, reply_size * 2);
+        if (tmp == NULL) {
+            perror("AHWM: ipc reply: realloc");
+            return;
+        }
+        reply_buf = tmp;
+        reply_size *= 2;
+    }
+}
+
+/* a window name, which may hold anything, as the end of a line */
+static void reply_string(char *s)
+{
+    int start;
+    char *p;
+
+    start = reply_len;
+    reply("%s\n", s);
+    for (p = reply_buf + start; p < reply_buf + reply_len - 1; p++) {
+        if (*p == '\n' || *p == '\r') *p = ' ';
+    }
+}
+
+/* split off the next blank-separated word of *S, or NULL if none */
+static char *next_word(char **s)
+{
+    char *word;
+
+    word = *s + strspn(*s, " \t");
+    if (*word == '\0') return NULL;
+    *s = word + strcspn(word, " \t");
+    if (**s != '\0') {
+        **s = '\0';
+        (*s)++;
+        *s += strspn(*s, " \t");
+    }
+    return word;
+}
+
+static client_t *find_window(char *s, Bool *focused)
+{
+    unsigned long w;
+    char *end;
+
+    if (focused != NULL) *focused = False;
+    if (s == NULL) return NULL;
+    if (strcmp(s, "focused") == 0) {
+        if (focused != NULL) *focused = True;
+        return focus_current;
+    }
+    w = strtoul(s, &end, 0);
+    if (end == s || *end != '\0') return NULL;
+    return client_find((Window)w);
+}
+
+/* what a bound function would get if a key were pressed in CLIENT */
+static void fake_event(XEvent *e, client_t *client)
+{
+    memset(e, 0, sizeof(XEvent));
+    e->xkey.type = KeyPress;
+    e->xkey.display = dpy;
+    e->xkey.window = client != NULL ? client->window : root_window;
+    e->xkey.root = root_window;
+    e->xkey.time = CurrentTime;
+    e->xkey.same_screen = True;
+}
+
+static Bool reply_window(client_t *client, void *ignored)
+{
+    reply("0x%08lx\n", (unsigned long)client->window);
+    return True;
+}
+
+static char *cmd_clients(char *args)
+{
+    client_t *client;
+    char flags[5], *f;
+
+    for (client = stacking_top(); client != NULL;
+         client = stacking_prev(client)) {
+        
+        f = flags;
+        if (client == focus_current) *f++ = 'f';
+        if (client->state == IconicState) *f++ = 'i';
+        if (client->omnipresent) *f++ = 'o';
+        if (client->unresponsive) *f++ = 'u';
+        if (f == flags) *f++ = '-';
+        *f = '\0';
+        reply("0x%08lx %u %d %d %d %d %s ", (unsigned long)client->window,
+              client->workspace, client->x, client->y,
+              client->width, client->height, flags);
+        reply_string(client->name);
+    }
+    return NULL;
+}
+
+static char *cmd_workspace(char *args)
+{
+    reply("%u %u\n", workspace_current, nworkspaces);
+    return NULL;
+}
+
+static char *cmd_focus_stack(char *args)
+{
+    focus_forall(reply_window, NULL);
+    return NULL;
+}
+
+static char *cmd_focus(char *args)
+{
+    client_t *client;
+
+    client = find_window(next_word(&args), NULL);
+    if (client == NULL) return "no such window";
+    if (client->state != NormalState) return "window is not mapped";
+    if (!client->omnipresent && client->workspace != workspace_current) {
+        workspace_goto(client->workspace);
+    }
+    stacking_raise(client);
+    focus_set(client, CurrentTime);
+    return NULL;
+}
+
+static char *cmd_move(char *args)
+{
+    client_t *client;
+    XEvent e;
+    type t;
+    arglist al;
+    int x, y;
+    unsigned int width, height;
+
+    client = find_window(next_word(&args), NULL);
+    if (client == NULL) return "no such window";
+    if (XParseGeometry(args, &x, &y, &width, &height) == NoValue) {
+        return "bad geometry";
+    }
+    t.type_type = STRING;
+    t.type_value.stringval = args;
+    al.arglist_arg = &t;
+    al.arglist_next = NULL;
+    fake_event(&e, client);
+    move_resize(&e, &al);
+    return NULL;
+}
+
+static char *cmd_goto(char *args)
+{
+    char *word, *end;
+    long ws;
+
+    word = next_word(&args);
+    if (word == NULL) return "no workspace given";
+    ws = strtol(word, &end, 10);
+    if (*end != '\0' || ws < 1 || ws > nworkspaces) {
+        return "no such workspace";
+    }
+    workspace_goto((unsigned int)ws);
+    return NULL;
+}
+
+static char *cmd_invoke(char *args)
+{
+    client_t *client;
+    XEvent e;
+    Bool focused;
+
+    client = find_window(next_word(&args), &focused);
+    if (client == NULL && !focused) return "no such window";
+    if (*args == '\0') return "no definition given";
+    fake_event(&e, client);
+    if (!prefs_invoke(args, &e)) return "no such definition";
+    return NULL;
+}
+
+static char *cmd_stats(char *args)
+{
+    pool_report(reply);
+    malloc_report(reply);
+    xstats_report(reply);
+    latency_report(reply);
+    return NULL;
+}
+
+static char *cmd_flight(char *args)
+{
+    char *file;
+
+    file = flight_dump(next_word(&args));
+    if (file == NULL) return strerror(errno);
+    reply("%s\n", file);
+    return NULL;
+}
+
+static char *cmd_requests(char *args)
+{
+    unsigned long requests, roundtrips;
+
+    if (!xstats_totals(&requests, &roundtrips))
+        return "RoundTripBudget is not set";
+    reply("%lu %lu\n", requests, roundtrips);
+    return NULL;
+}
+
+static char *cmd_sync(char *args)
+{
+    XSync(dpy, False);
+    return NULL;
+}
+
+#else /* !USE_IPC */
+
+void ipc_init()
+{
+}
+
+#endif /* USE_IPC */
@@ -0,0 +1,82 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef IPC_H
+#define IPC_H
+
+#include "config.h"
+
+/*
+ * A control socket, so scripts can drive AHWM without a dozen X round
+ * trips per action and without racing us for window properties.
+ * 
+ * The socket is a Unix domain stream socket; its path is put into
+ * our environment as AHWM_SOCKET so programs we launch can find it.
+ * It defaults to /tmp/ahwm-UID/DISPLAY, or AHWM_SOCKET if that was
+ * already set when we started.
+ * 
+ * A client writes newline-terminated commands.  Every command is
+ * answered with zero or more lines of data followed by a line that
+ * reads "ok" or "error " and a reason.  All the commands that arrive
+ * in one read are run together and their answers written back with
+ * one write, so a dashboard can send its whole set of queries at once.
+ * Queries are answered from our own state, never from the server.
+ * 
+ * WINDOW is a client window id (decimal or 0x-prefixed hexadecimal)
+ * or "focused".
+ * 
+ * clients              one line per client, top of stack first:
+ *                      window workspace x y width height flags name
+ *                      flags are any of f (focused), i (iconic),
+ *                      o (omnipresent), u (not answering pings) or -
+ * workspace            current workspace and number of workspaces
+ * focus-stack          windows of the current workspace, most
+ *                      recently focused first
+ * focus WINDOW         go to the window's workspace, raise and focus it
+ * move WINDOW GEOMETRY like the MoveResize() function
+ * goto N               like the GotoWorkspace() function
+ * invoke WINDOW NAME   run the Define()d function composition NAME (the
+ *                      rest of the line) as if bound to a key pressed
+ *                      in WINDOW
+ * stats                the statistics SIGUSR1 writes to stderr
+ * flight [FILE]        write the flight recorder (see flight.h) to
+ *                      FILE or its usual file, and answer the file
+ * requests             X requests sent and replies waited for by event
+ *                      handlers since start-up, if RoundTripBudget is
+ *                      set (see xstats.h)
+ * sync                 wait for the server to catch up; the events
+ *                      that brings are handled before any command that
+ *                      arrives afterwards
+ * 
+ * A client which doesn't read its answers is disconnected.
+ */
+
+/*
+ * Create the socket.  Depends on event_init() and prefs_init().
+ */
+
+void ipc_init();
+
+#endif /* IPC_H */
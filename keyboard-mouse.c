@@ -50,6 +50,7 @@
 #include "stacking.h"
 #include "ewmh.h"
 #include "compat.h"
+#include "latency.h"
 
 #ifndef MIN
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
@@ -292,20 +293,20 @@ void mouse_bind_ex(unsigned int button, unsigned int modifiers,
 void keyboard_unbind_ex(unsigned int keycode, unsigned int modifiers,
                         int depress) 
 {
-    boundkey *kb, *tmp;
+    boundkey *kb, *tmp, *next;
 
     tmp = NULL;
-    for (kb = boundkeys; kb != NULL; kb = kb->next) {
+    for (kb = boundkeys; kb != NULL; kb = next) {
+        next = kb->next;
         if (kb->keycode == keycode
             && kb->modifiers == modifiers
             && kb->depress == depress) {
-            if (tmp == NULL) {
-                boundkeys = boundkeys->next;
-                free(kb);
-            } else {
-                tmp->next = kb->next;
-                free(kb);
-            }
+            if (tmp == NULL)
+                boundkeys = next;
+            else
+                tmp->next = next;
+            Free(kb);
+            continue;
         }
         tmp = kb;
     }
@@ -314,21 +315,21 @@ void keyboard_unbind_ex(unsigned int keycode, unsigned int modifiers,
 void mouse_unbind_ex(unsigned int button, unsigned int modifiers,
                      click_type type, int location)
 {
-    boundbutton *mb, *tmp;
+    boundbutton *mb, *tmp, *next;
 
     tmp = NULL;
-    for (mb = boundbuttons; mb != NULL; mb = mb->next) {
+    for (mb = boundbuttons; mb != NULL; mb = next) {
+        next = mb->next;
         if (mb->button == button
             && mb->modifiers == modifiers
             && mb->type == type
             && mb->location == location) {
-            if (tmp == NULL) {
-                boundbuttons = boundbuttons->next;
-                free(mb);
-            } else {
-                tmp->next = mb->next;
-                free(mb);
-            }
+            if (tmp == NULL)
+                boundbuttons = next;
+            else
+                tmp->next = next;
+            Free(mb);
+            continue;
         }
         tmp = mb;
     }
@@ -625,7 +626,7 @@ Bool keyboard_handle_event(XKeyEvent *xevent)
         if (quoting) {
             unquote((XEvent *)xevent);
         } else {
-            (*fn)((XEvent *)xevent, args);
+            latency_call(fn, (XEvent *)xevent, args);
         }
         return True;
     }
@@ -700,7 +701,7 @@ static Bool mouse_invoke(XEvent *xevent, click_type type)
             bb->modifiers == saved_state) {
 
             time = xevent->xbutton.time;
-            (bb->function)(xevent, bb->args);
+            latency_call(bb->function, xevent, bb->args);
             XUngrabPointer(dpy, time);
             return True;
         }
@@ -953,7 +954,7 @@ Bool mouse_handle_event(XEvent *xevent)
                             && xevent->type == ButtonRelease
                             && in_window(xevent, xevent->xbutton.window))) {
                         debug(("\tCalling function\n"));
-                        (*mb->function)(xevent, mb->args);
+                        latency_call(mb->function, xevent, mb->args);
                     } else {
                         debug(("\tNot calling function\n"));
                     }
@@ -39,9 +39,12 @@
 #include <X11/Xatom.h>
 
 #include "kill.h"
+#include "atoms.h"
 #include "event.h"
 #include "debug.h"
 #include "timer.h"
+#include "ewmh.h"
+#include "paint.h"
 
 /*
  * Sometimes we'll set a timer on a client and unconditionally kill
@@ -57,8 +60,28 @@ typedef struct _murder_info {
     client_t *client;
     Window window;
     unsigned long hash;
+    Time stamp;                 /* ping sent along with the request */
 } murder_info;
 
+/*
+ * Every client which speaks _NET_WM_PING is on a ring threaded
+ * through the client structures themselves, so pinging hundreds of
+ * windows costs one periodic timer and no allocation at all.  Each
+ * tick we ping the clients whose last ping was answered long enough
+ * ago and mark as unresponsive those sitting on an overdue ping.
+ * We don't ping a client again until it answers; the server doesn't
+ * lose events, so a hung client will answer the outstanding ping
+ * whenever it wakes up.
+ */
+
+#define PING_TICK     1000      /* msecs between looks at the ring */
+#define PING_INTERVAL 5000      /* msecs between pings of one client */
+#define PING_TIMEOUT  3000      /* msecs before we call a client hung */
+
+static client_t *ping_ring = NULL;
+static timer *ping_timer = NULL;
+static Time ping_clock = 0;
+
 #ifndef HAVE_SYS_NMLN
 #define SYS_NMLN 64
 #endif
@@ -69,6 +92,10 @@ static Atom _NET_WM_PID;
 static void set_murder_timer(client_t *client);
 static void murder_on_timeout(timer *t, void *v);
 static unsigned long compute_hash(client_t *client);
+static void ping_send(client_t *client, struct timeval *now);
+static void ping_mark(client_t *client, Bool unresponsive);
+static void ping_on_tick(timer *t, void *v);
+static long msecs_since(struct timeval *then, struct timeval *now);
 
 /*
  * ICCCM is somewhat vague about exactly what this is supposed to
@@ -94,12 +121,17 @@ void kill_init()
     }
     strncpy(my_hostname, utsn.nodename, SYS_NMLN);
     my_hostname[SYS_NMLN - 1] = '\0';
-    _NET_WM_PID = XInternAtom(dpy, "_NET_WM_PID", False);
+}
+
+void kill_declare_atoms()
+{
+    atoms_declare(&_NET_WM_PID, "_NET_WM_PID");
 }
 
 void kill_nicely(XEvent *xevent, arglist *ignored)
 {
     client_t *client;
+    struct timeval now;
 
     client = client_find(xevent->xbutton.window);
     if (client == NULL) {
@@ -110,6 +142,11 @@ void kill_nicely(XEvent *xevent, arglist *ignored)
         debug(("\tPolitely requesting window to die\n"));
         client_sendmessage(client, WM_DELETE_WINDOW, event_timestamp,
                            0, 0, 0);
+        /* an answer to this tells us it's alive if it's still around */
+        if (client->protocols & PROTO_PING) {
+            timer_now(&now);
+            ping_send(client, &now);
+        }
         if (client->patience != 0) {
             set_murder_timer(client);
         }
@@ -214,6 +251,7 @@ static void set_murder_timer(client_t *client)
     info->window = client->window;
     info->client = client;
     info->hash = compute_hash(client);
+    info->stamp = client->ping_stamp;
     timer_new(client->patience, murder_on_timeout, info);
 }
 
@@ -232,8 +270,156 @@ static void murder_on_timeout(timer *t, void *v)
         free(info);
         return;
     }
+    /* a client that answered our ping is alive, and is probably
+     * asking the user whether to save something */
+    if ((client->protocols & PROTO_PING)
+        && (CARD32)(client->pong_stamp - info->stamp) < 0x80000000UL) {
+        debug(("\t%s is still answering pings, not killing it\n",
+               client_dbg(client)));
+        free(info);
+        return;
+    }
     free(info);
     fflush(stdout);
     kill_using_net_wm_pid(client);
     XKillClient(dpy, client->window);
 }
+
+static long msecs_since(struct timeval *then, struct timeval *now)
+{
+    return (now->tv_sec - then->tv_sec) * 1000
+        + (now->tv_usec - then->tv_usec) / 1000;
+}
+
+static void ping_send(client_t *client, struct timeval *now)
+{
+    /* the timestamp only has to come back to us unchanged, but keep
+     * it close to server time for clients which look at it */
+    ping_clock++;
+    if ((CARD32)(event_timestamp - ping_clock) < 0x80000000UL) {
+        ping_clock = event_timestamp;
+    }
+    ping_clock = (CARD32)ping_clock;
+    client->ping_stamp = ping_clock;
+    client->ping_sent = *now;
+    client_sendmessage(client, _NET_WM_PING, ping_clock,
+                       client->window, 0, 0);
+}
+
+static void ping_mark(client_t *client, Bool unresponsive)
+{
+    if (client->unresponsive == unresponsive) {
+        return;
+    }
+    debug(("\t%s is %s\n", client_dbg(client),
+           unresponsive ? "not responding" : "responding again"));
+    client->unresponsive = unresponsive;
+    if (client->titlebar != None) {
+        paint_titlebar_invalidate(client);
+        paint_titlebar(client);
+    }
+}
+
+static void ping_on_tick(timer *t, void *v)
+{
+    client_t *client;
+    struct timeval now;
+    long age;
+
+    if (ping_ring == NULL) {
+        return;
+    }
+    timer_now(&now);
+    client = ping_ring;
+    do {
+        age = msecs_since(&client->ping_sent, &now);
+        if (client->ping_stamp != client->pong_stamp) {
+            if (age >= PING_TIMEOUT) {
+                ping_mark(client, True);
+            }
+        } else if (age >= PING_INTERVAL) {
+            ping_send(client, &now);
+        }
+        client = client->ping_next;
+    } while (client != ping_ring);
+}
+
+void kill_ping_update(client_t *client)
+{
+    if (!(client->protocols & PROTO_PING)) {
+        ping_mark(client, False);
+        kill_ping_remove(client);
+        return;
+    }
+    if (client->ping_next != NULL) {
+        return;
+    }
+
+    /* first ping goes out after one interval; the client has
+     * better things to do while it's starting up */
+    client->ping_rtt = -1;
+    client->pong_stamp = client->ping_stamp;
+    timer_now(&client->ping_sent);
+    if (ping_ring == NULL) {
+        client->ping_next = client->ping_prev = client;
+        ping_ring = client;
+        if (ping_timer == NULL) {
+            ping_timer = timer_new_periodic(PING_TICK, ping_on_tick, NULL);
+        } else {
+            timer_rearm(ping_timer, PING_TICK);
+        }
+    } else {
+        client->ping_next = ping_ring;
+        client->ping_prev = ping_ring->ping_prev;
+        ping_ring->ping_prev->ping_next = client;
+        ping_ring->ping_prev = client;
+    }
+}
+
+void kill_ping_remove(client_t *client)
+{
+    if (client->ping_next == NULL) {
+        return;
+    }
+    if (client->ping_next == client) {
+        ping_ring = NULL;
+        if (ping_timer != NULL) {
+            timer_disarm(ping_timer);
+        }
+    } else {
+        client->ping_prev->ping_next = client->ping_next;
+        client->ping_next->ping_prev = client->ping_prev;
+        if (ping_ring == client) {
+            ping_ring = client->ping_next;
+        }
+    }
+    client->ping_next = client->ping_prev = NULL;
+    client->unresponsive = False;
+}
+
+Bool kill_handle_pong(XClientMessageEvent *xevent)
+{
+    client_t *client;
+    struct timeval now;
+
+    if (xevent->message_type != WM_PROTOCOLS || xevent->format != 32
+        || (Atom)xevent->data.l[0] != _NET_WM_PING) {
+        return False;
+    }
+    client = client_find((Window)xevent->data.l[2]);
+    if (client == NULL || client->ping_next == NULL) {
+        return True;
+    }
+    /* stale answers and duplicates are of no interest */
+    if ((CARD32)xevent->data.l[1] != (CARD32)client->ping_stamp
+        || client->pong_stamp == client->ping_stamp) {
+        return True;
+    }
+    timer_now(&now);
+    client->pong_stamp = client->ping_stamp;
+    client->ping_rtt = msecs_since(&client->ping_sent, &now);
+    debug(("\tPing round trip to %s took %d msecs\n",
+           client_dbg(client), client->ping_rtt));
+    ping_mark(client, False);
+    return True;
+}
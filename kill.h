@@ -36,6 +36,12 @@
 
 void kill_init();
 
+/*
+ * Declare our atoms with atoms_declare()
+ */
+
+void kill_declare_atoms();
+
 /*
  * Send a DELETE client message if the client supports it, otherwise
  * use XKillClient().  Meant to be bound to a key or pointer event.
@@ -49,4 +55,22 @@ void kill_nicely(XEvent *e, arglist *ignored);
 
 void kill_with_extreme_prejudice(XEvent *e, arglist *ignored);
 
+/*
+ * Clients which speak _NET_WM_PING are pinged in the background so
+ * we can tell when one has hung; client->unresponsive is set and the
+ * titlebar redrawn when a ping goes unanswered for too long.  Call
+ * kill_ping_update() whenever client->protocols changes, and
+ * kill_ping_remove() before freeing a client.  Neither allocates.
+ */
+
+void kill_ping_update(client_t *client);
+void kill_ping_remove(client_t *client);
+
+/*
+ * Handle a ClientMessage which may be an answer to a ping.  Returns
+ * True if the message was a ping reply (even a stale one).
+ */
+
+Bool kill_handle_pong(XClientMessageEvent *xevent);
+
 #endif /* KILL_H */
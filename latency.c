@@ -0,0 +1,243 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "ahwm.h"
+#include "latency.h"
+#include "atoms.h"
+#include "timer.h"
+#include "prefs.h"
+#include "xev.h"
+#include "malloc.h"
+#include "compat.h"
+
+/* eight linear buckets per power of two, up to 2^32 microseconds */
+#define SUB_BITS 3
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define NBUCKETS (SUB_BUCKETS + (32 - SUB_BITS) * SUB_BUCKETS)
+
+#define LATENCY_EVENTS (LASTEvent + 1) /* last is all extension events */
+#define LATENCY_FUNCTIONS 32
+#define LATENCY_PUBLISH 10000   /* msecs between property updates */
+
+typedef struct _histogram {
+    unsigned long total;
+    unsigned long max;
+    CARD32 counts[NBUCKETS];
+} histogram;
+
+static histogram waits[LATENCY_EVENTS];
+static histogram handlers[LATENCY_EVENTS];
+
+static struct {
+    key_fn fn;
+    histogram h;
+} functions[LATENCY_FUNCTIONS];
+static int nfunctions = 0;
+
+static CARD32 clock_offset;     /* our msecs - server msecs, at best */
+static Bool have_offset = False;
+static Bool changed = False;
+
+static Atom _AHWM_LATENCY;
+static timer *publish_timer = NULL;
+
+static char *text = NULL;       /* for building the property */
+static int text_len, text_size;
+
+static void publish(timer *t, void *ignored);
+
+void latency_declare_atoms()
+{
+    atoms_declare(&_AHWM_LATENCY, "_AHWM_LATENCY");
+}
+
+void latency_init()
+{
+    publish_timer = timer_new_periodic(LATENCY_PUBLISH, publish, NULL);
+}
+
+static int bucket(unsigned long v)
+{
+    int e;
+
+    if (v < SUB_BUCKETS) return v;
+    if (v > 0xffffffffUL) v = 0xffffffffUL;
+    for (e = SUB_BITS; (v >> (e + 1)) != 0; e++)
+        ;
+    return SUB_BUCKETS + (e - SUB_BITS) * SUB_BUCKETS
+        + ((v >> (e - SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/* the largest value which falls into bucket B */
+static unsigned long bucket_high(int b)
+{
+    int e, sub;
+
+    if (b < SUB_BUCKETS) return b;
+    e = (b - SUB_BUCKETS) / SUB_BUCKETS + SUB_BITS;
+    sub = (b - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((unsigned long)(SUB_BUCKETS + sub + 1) << (e - SUB_BITS)) - 1;
+}
+
+static void record(histogram *h, unsigned long v)
+{
+    h->counts[bucket(v)]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+    changed = True;
+}
+
+/* the value below which fraction Q (in thousandths) of samples fall */
+static unsigned long percentile(histogram *h, int q)
+{
+    unsigned long want, seen;
+    int b;
+
+    want = (h->total * q + 999) / 1000;
+    seen = 0;
+    for (b = 0; b < NBUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= want) break;
+    }
+    if (b >= NBUCKETS || bucket_high(b) > h->max) return h->max;
+    return bucket_high(b);
+}
+
+void latency_event(XEvent *event, Time server_time, flight_record *r)
+{
+    CARD32 now, delta;
+    int type;
+
+    type = event->type;
+    if (type == PropertyNotify && event->xproperty.atom == _AHWM_LATENCY
+        && event->xproperty.window == root_window)
+        return;
+    if (type < 0 || type >= LASTEvent) type = LASTEvent;
+    record(&handlers[type], r->arg);
+    if (server_time == CurrentTime) return;
+
+    now = r->sec * 1000 + r->usec / 1000;
+    delta = now - (CARD32)server_time;
+    /* both clocks wrap, so compare differences, not values */
+    if (!have_offset || (INT32)(delta - clock_offset) < 0) {
+        clock_offset = delta;
+        have_offset = True;
+    }
+    record(&waits[type], (unsigned long)(delta - clock_offset) * 1000);
+}
+
+void latency_call(key_fn fn, XEvent *e, struct _arglist *args)
+{
+    struct timeval start, end;
+    int i;
+
+    timer_now(&start);
+    (*fn)(e, args);
+    timer_now(&end);
+
+    for (i = 0; i < nfunctions; i++) {
+        if (functions[i].fn == fn) break;
+    }
+    if (i == nfunctions) {
+        if (nfunctions == LATENCY_FUNCTIONS) return;
+        functions[nfunctions++].fn = fn;
+    }
+    record(&functions[i].h, (end.tv_sec - start.tv_sec) * 1000000
+           + end.tv_usec - start.tv_usec);
+}
+
+static void report_one(report_fn out, char *kind, const char *name,
+                       histogram *h)
+{
+    if (h->total == 0) return;
+    out("latency: %-8s %-24s %8lu %8lu %8lu %8lu %8lu %8lu\n",
+        kind, name, h->total, percentile(h, 500), percentile(h, 900),
+        percentile(h, 990), percentile(h, 999), h->max);
+}
+
+void latency_report(report_fn out)
+{
+    const char *name;
+    int i;
+
+    out("latency: %-8s %-24s %8s %8s %8s %8s %8s %8s\n", "kind", "name",
+        "count", "p50", "p90", "p99", "p99.9", "max");
+    for (i = 0; i < LATENCY_EVENTS; i++) {
+        name = xev_name(i);
+        if (name == NULL) name = "extension";
+        report_one(out, "wait", name, &waits[i]);
+        report_one(out, "handler", name, &handlers[i]);
+    }
+    for (i = 0; i < nfunctions; i++) {
+        name = prefs_function_name(functions[i].fn);
+        if (name == NULL) name = "unknown";
+        report_one(out, "function", name, &functions[i].h);
+    }
+}
+
+/* a report_fn which appends to 'text' */
+static void append(char *fmt, ...)
+{
+    va_list args;
+    char *tmp;
+    int n;
+
+    for (;;) {
+        va_start(args, fmt);
+        n = vsnprintf(text + text_len, text_size - text_len, fmt, args);
+        va_end(args);
+        if (n >= 0 && n < text_size - text_len) {
+            text_len += n;
+            return;
+        }
+        tmp = Realloc(text, text_size * 2);
+        if (tmp == NULL) return;
+        text = tmp;
+        text_size *= 2;
+    }
+}
+
+static void publish(timer *t, void *ignored)
+{
+    if (!changed) return;
+    changed = False;
+    if (text == NULL) {
+        text = Malloc(4096);
+        if (text == NULL) return;
+        text_size = 4096;
+    }
+    text_len = 0;
+    latency_report(append);
+    XChangeProperty(dpy, root_window, _AHWM_LATENCY, XA_STRING, 8,
+                    PropModeReplace, (unsigned char *)text, text_len);
+}
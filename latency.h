@@ -0,0 +1,97 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+
+#include "keyboard-mouse.h"
+#include "flight.h"
+#include "debug.h"
+
+/*
+ * Latency histograms: for every kind of event, how long events waited
+ * between the server sending them and us getting to them, and how
+ * long their handlers took; and for every bindable function (see
+ * prefs.c:fn_table), how long it took.  Interactive functions such as
+ * MoveInteractively count until the move is over.
+ * 
+ * Histograms are log-linear, as in HdrHistogram: eight buckets per
+ * power of two microseconds, so any percentile is within 12.5% of
+ * the truth, in fixed-size arrays.  Recording a value is a couple of
+ * shifts and an increment.
+ * 
+ * Queue waits are only known for events which carry a server
+ * timestamp (key, button, motion, crossing and property events).
+ * The server's clock is not ours, so a wait is measured relative to
+ * the shortest one seen, which is taken to be no wait at all; waits
+ * have millisecond resolution.
+ * 
+ * The count, 50th, 90th, 99th and 99.9th percentiles and maximum of
+ * each histogram (in microseconds) are printed on SIGUSR1, returned
+ * by the control socket's "stats" command, and kept in the root
+ * window's _AHWM_LATENCY property (type STRING, one line per
+ * histogram), which is brought up to date every ten seconds.
+ */
+
+/*
+ * Declare the property atom with atoms_declare()
+ */
+
+void latency_declare_atoms();
+
+/*
+ * Start the timer.  Depends on timer_init().
+ */
+
+void latency_init();
+
+/*
+ * Record EVENT, sent by the server at SERVER_TIME (CurrentTime if
+ * unknown), whose handling is described by RECORD (see
+ * event_dispatch()).  The PropertyNotify for our own _AHWM_LATENCY
+ * is not recorded, or publishing it would always leave something new
+ * to publish.
+ */
+
+void latency_event(XEvent *event, Time server_time, flight_record *record);
+
+/*
+ * Call bindable function FN and record how long it took.
+ */
+
+void latency_call(key_fn fn, XEvent *e, struct _arglist *args);
+
+/*
+ * Write the percentiles of every histogram with anything in it
+ * through OUT.
+ */
+
+void latency_report(report_fn out);
+
+#endif /* LATENCY_H */
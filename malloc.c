@@ -26,68 +26,264 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
 
 #include "ahwm.h"
 #include "malloc.h"
+#include "debug.h"
+
+#if defined(HAVE_EXECINFO_H) && defined(HAVE_BACKTRACE)
+#define ALLOC_BACKTRACE
+#endif
+
+/*
+ * The site table is open-addressed on the address of the __FILE__
+ * string and the line number.  A program this size has a couple of
+ * hundred call sites; if we ever run out, everything else is lumped
+ * into the first entry.
+ */
+
+#define ALLOC_SITES 512
+#define ALLOC_MAGIC 0xa110cb10
+
+typedef struct _alloc_site {
+    char *file;                 /* NULL if the entry is free */
+    int line;
+    unsigned long live_objects;
+    unsigned long live_bytes;
+    unsigned long allocs;
+} alloc_site;
+
+/* sixteen bytes so the caller's memory stays aligned for anything */
+typedef union _alloc_header {
+    struct {
+        size_t size;
+        unsigned int site;
+        unsigned int magic;
+    } h;
+    char pad[16];
+} alloc_header;
+
+static alloc_site sites[ALLOC_SITES] = { { "(other)", 0, 0, 0, 0 } };
+static unsigned long total_live_bytes = 0;
+static unsigned long total_allocs = 0;
+
+#ifdef ALLOC_BACKTRACE
+
+#define ALLOC_SAMPLES 32
+#define ALLOC_FRAMES 12
+
+typedef struct _alloc_sample {
+    unsigned int site;
+    size_t size;
+    int nframes;
+    void *frames[ALLOC_FRAMES];
+} alloc_sample;
+
+static alloc_sample samples[ALLOC_SAMPLES];
+static int next_sample = 0;
+static unsigned long sample_every = 0;
+static unsigned long sample_countdown = 0;
+
+#endif /* ALLOC_BACKTRACE */
 
-#ifdef DEBUG
+void malloc_init()
+{
+#ifdef ALLOC_BACKTRACE
+    char *s;
 
-static FILE *malloc_file = NULL;
+    s = getenv("AHWM_ALLOC_SAMPLE");
+    if (s != NULL) {
+        sample_every = strtoul(s, NULL, 10);
+        sample_countdown = sample_every;
+    }
+#endif
+}
 
-void malloc_openfile()
+static unsigned int site_lookup(char *file, int line)
 {
-    if (malloc_file == NULL) {
-        malloc_file = fopen("./malloc-out", "w");
-        if (malloc_file == NULL) {
-            perror("AHWM: fopen \"./malloc-out\" for writing");
-            exit(1);
+    unsigned int i, n;
+
+    i = ((unsigned long)file / sizeof(char *) * 31 + line) % ALLOC_SITES;
+    for (n = 0; n < ALLOC_SITES; n++) {
+        if (i == 0) i = 1;      /* entry 0 is the overflow */
+        if (sites[i].file == NULL) {
+            sites[i].file = file;
+            sites[i].line = line;
+            return i;
         }
-        /* set line buffered */
-        setvbuf(malloc_file, NULL, _IOLBF, 0);
+        if (sites[i].line == line && sites[i].file == file)
+            return i;
+        i = (i + 1) % ALLOC_SITES;
     }
+    return 0;
+}
+
+#ifdef ALLOC_BACKTRACE
+static void sample(unsigned int site, size_t size)
+{
+    alloc_sample *s;
+
+    if (sample_every == 0 || --sample_countdown > 0) return;
+    sample_countdown = sample_every;
+    s = &samples[next_sample];
+    next_sample = (next_sample + 1) % ALLOC_SAMPLES;
+    s->site = site;
+    s->size = size;
+    s->nframes = backtrace(s->frames, ALLOC_FRAMES);
+}
+#endif /* ALLOC_BACKTRACE */
+
+/* account for a block of SIZE bytes and return the caller's part */
+static void *track(alloc_header *hdr, size_t size, int line, char *file)
+{
+    unsigned int site;
+
+    site = site_lookup(file, line);
+    hdr->h.size = size;
+    hdr->h.site = site;
+    hdr->h.magic = ALLOC_MAGIC;
+    sites[site].live_objects++;
+    sites[site].live_bytes += size;
+    sites[site].allocs++;
+    total_live_bytes += size;
+    total_allocs++;
+#ifdef ALLOC_BACKTRACE
+    sample(site, size);
+#endif
+    return hdr + 1;
+}
+
+static void untrack(alloc_header *hdr)
+{
+    alloc_site *s;
+
+    s = &sites[hdr->h.site];
+    s->live_objects--;
+    s->live_bytes -= hdr->h.size;
+    total_live_bytes -= hdr->h.size;
+    hdr->h.magic = 0;
+}
+
+/* the header of PTR, or NULL (with a complaint) if it isn't ours */
+static alloc_header *header(void *ptr, char *what, int line, char *file)
+{
+    alloc_header *hdr;
+
+    hdr = (alloc_header *)ptr - 1;
+    if (hdr->h.magic != ALLOC_MAGIC || hdr->h.site >= ALLOC_SITES) {
+        fprintf(stderr, "AHWM: %s of unknown or freed pointer at %s:%d\n",
+                what, file, line);
+        return NULL;
+    }
+    return hdr;
 }
 
 void *my_malloc(size_t size, int line, char *file)
 {
-    void *retval;
-    
-    malloc_openfile();
-    retval = malloc(size);
-    /* "%p" format is not portable, but DEBUG builds are meant
-     * only for me */
-    fprintf(malloc_file, "MALLOC %d FROM %s:%d RETURNS %p\n",
-            size, file, line, retval);
-    return retval;
+    alloc_header *hdr;
+
+    hdr = malloc(sizeof(alloc_header) + size);
+    if (hdr == NULL) return NULL;
+    return track(hdr, size, line, file);
 }
 
 void *my_realloc(void *ptr, size_t size, int line, char *file)
 {
-    void *retval;
+    alloc_header *hdr, *tmp;
 
-    malloc_openfile();
-    retval = realloc(ptr, size);
-    fprintf(malloc_file, "REALLOC %p , %d FROM %s:%d RETURNS %p\n",
-            ptr, size, file, line, retval);
-    return retval;
+    if (ptr == NULL) return my_malloc(size, line, file);
+    hdr = header(ptr, "Realloc", line, file);
+    if (hdr == NULL) return NULL;
+    tmp = realloc(hdr, sizeof(alloc_header) + size);
+    if (tmp == NULL) return NULL;
+    /* the block now belongs to the site which resized it */
+    untrack(tmp);
+    return track(tmp, size, line, file);
 }
 
 char *my_strdup(char *ptr, int line, char *file)
 {
     char *retval;
+    size_t len;
 
-    malloc_openfile();
-    retval = strdup(ptr);
-    fprintf(malloc_file, "STRDUP '%s' FROM %s:%d RETURNS %p\n",
-            ptr, file, line, retval);
+    len = strlen(ptr) + 1;
+    retval = my_malloc(len, line, file);
+    if (retval == NULL) return NULL;
+    memcpy(retval, ptr, len);
     return retval;
 }
 
 void my_free(void *ptr, int line, char *file)
 {
-    malloc_openfile();
-    fprintf(malloc_file, "FREE %p FROM %s:%d\n",
-            ptr, file, line);
-    free(ptr);
+    alloc_header *hdr;
+
+    if (ptr == NULL) return;
+    /* leak it rather than corrupt the heap if it isn't ours */
+    hdr = header(ptr, "Free", line, file);
+    if (hdr == NULL) return;
+    untrack(hdr);
+    free(hdr);
 }
 
-#endif /* DEBUG */
+static int compare_sites(const void *a, const void *b)
+{
+    const alloc_site *x = *(const alloc_site **)a;
+    const alloc_site *y = *(const alloc_site **)b;
+
+    if (x->live_bytes != y->live_bytes)
+        return x->live_bytes < y->live_bytes ? 1 : -1;
+    if (x->allocs != y->allocs)
+        return x->allocs < y->allocs ? 1 : -1;
+    return 0;
+}
+
+void malloc_report(report_fn out)
+{
+    static alloc_site *sorted[ALLOC_SITES];
+    alloc_site *s;
+    int i, n;
+
+    n = 0;
+    for (i = 0; i < ALLOC_SITES; i++)
+        if (sites[i].file != NULL && sites[i].allocs > 0)
+            sorted[n++] = &sites[i];
+    qsort(sorted, n, sizeof(alloc_site *), compare_sites);
+
+    out("malloc: %lu bytes live, %lu allocations, %d sites\n",
+        total_live_bytes, total_allocs, n);
+    out("malloc: live-bytes live-objects allocs site\n");
+    for (i = 0; i < n; i++) {
+        s = sorted[i];
+        out("malloc: %10lu %12lu %6lu %s:%d\n", s->live_bytes,
+            s->live_objects, s->allocs, s->file, s->line);
+    }
+
+#ifdef ALLOC_BACKTRACE
+    if (sample_every == 0) return;
+    for (i = 0; i < ALLOC_SAMPLES; i++) {
+        alloc_sample *smp;
+        char **names;
+        int j;
+
+        smp = &samples[(next_sample + i) % ALLOC_SAMPLES];
+        if (smp->nframes == 0) continue;
+        out("malloc: sample %lu bytes at %s:%d\n", (unsigned long)smp->size,
+            sites[smp->site].file, sites[smp->site].line);
+        /* backtrace_symbols() uses the real malloc, so free() this */
+        names = backtrace_symbols(smp->frames, smp->nframes);
+        for (j = 0; j < smp->nframes; j++) {
+            if (names != NULL)
+                out("malloc:     %s\n", names[j]);
+            else
+                out("malloc:     %p\n", smp->frames[j]);
+        }
+        free(names);
+    }
+#endif /* ALLOC_BACKTRACE */
+}
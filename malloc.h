@@ -24,7 +24,17 @@
  */
 
 /*
- * Had a free-something-twice bug, needed this
+ * Every allocation goes through these, so we always know who owns
+ * the heap.  Each call site (file and line) gets an entry in a fixed
+ * table counting its live objects, live bytes and total allocations;
+ * malloc_report() prints the table, largest first.  The bookkeeping
+ * is a small header in front of each block, so memory from Malloc(),
+ * Realloc() or Strdup() must be given back with Free(), never with
+ * free() or XFree(), and vice versa.
+ * 
+ * If AHWM_ALLOC_SAMPLE is set to N in the environment, every Nth
+ * allocation also records a backtrace (where the system can make
+ * one), and the most recent of these are printed with the report.
  */
 
 #ifndef MALLOC_H
@@ -37,8 +47,7 @@
 
 #include "compat.h"
 #include "ahwm.h"
-
-#ifdef DEBUG
+#include "debug.h"
 
 #define Malloc(size) my_malloc(size, __LINE__, __FILE__)
 #define Free(ptr) my_free(ptr, __LINE__, __FILE__)
@@ -50,13 +59,13 @@ void my_free(void *, int, char *);
 void *my_realloc(void *, size_t, int, char *);
 char *my_strdup(char *, int, char *);
 
-#else
+void malloc_init();
 
-#define Malloc(size) malloc(size)
-#define Free(ptr) free(ptr)
-#define Realloc(ptr,size) realloc(ptr, size)
-#define Strdup(ptr) strdup(ptr)
+/*
+ * Write the per-call-site statistics (and sampled backtraces) through
+ * OUT.
+ */
 
-#endif /* DEBUG */
+void malloc_report(report_fn out);
 
 #endif /* MALLOC_H */
@@ -89,9 +89,6 @@ static int keycode_Right, keycode_j, keycode_k, keycode_l, keycode_h;
 static int keycode_w, keycode_a, keycode_s, keycode_d;
 static int keycode_Control_L, keycode_Control_R, keycode_space;
 
-/* optimization, see move_display_geometry() */
-static char *titlebar_display = NULL;
-
 static void compress_motion(XEvent *xevent);
 static void process_resize(client_t *client, int new_x, int new_y,
                            resize_direction_t direction,
@@ -551,8 +548,6 @@ void move_client(XEvent *xevent, arglist *ignored)
 
     if (client != NULL) {
         XMoveWindow(dpy, client->frame, client->x, client->y);
-        if (client->name != NULL) Free(client->name);
-        titlebar_display = NULL;
         client_set_name(client);
         paint_titlebar(client);
         /* must send a synthetic ConfigureNotify to the client
@@ -783,8 +778,7 @@ void resize_client(XEvent *xevent, arglist *al)
                   CurrentTime);
     /* we take over the titlebar display routines in process_resize() */
     if (client->titlebar != None) {
-        free(client->name);
-        client->name = Strdup("");
+        client_set_name_string(client, "");
         paint_titlebar(client);
     }
     /* just draws the initial drafting lines with FIRST argument */
@@ -1017,8 +1011,6 @@ void resize_client(XEvent *xevent, arglist *al)
         } else {
             XResizeWindow(dpy, client->window, client->width, client->height);
         }
-        if (client->name != NULL) Free(client->name);
-        titlebar_display = NULL;
         client_set_name(client);
         paint_titlebar(client);
     }
@@ -1706,14 +1698,11 @@ static void geometry_string(char *s, char *buf, int len, client_t *client,
 
 static void move_display_geometry(client_t *client)
 {
-    if (titlebar_display == NULL || client->name != titlebar_display) {
-        titlebar_display = Malloc(256); /* arbitrary, whatever */
-        if (titlebar_display == NULL) return;
-        if (client->name != NULL) Free(client->name);
-        client->name = titlebar_display;
-    }
-    geometry_string("Moving", client->name, 256, client,
+    char buf[256];
+
+    geometry_string("Moving", buf, 256, client,
                     client->x, client->y, client->width, client->height);
+    client_set_name_string(client, buf);
     paint_titlebar(client);
 }
 
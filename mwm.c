@@ -29,15 +29,16 @@
 
 #include "ahwm.h"
 #include "mwm.h"
+#include "atoms.h"
 #include "MwmUtil.h"
 #include "client.h"
 #include "debug.h"
 
 Atom _MOTIF_WM_HINTS;
 
-void mwm_init()
+void mwm_declare_atoms()
 {
-    _MOTIF_WM_HINTS = XInternAtom(dpy, "_MOTIF_WM_HINTS", False);
+    atoms_declare(&_MOTIF_WM_HINTS, "_MOTIF_WM_HINTS");
 }
 
 void mwm_apply(client_t *client)
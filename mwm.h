@@ -37,10 +37,11 @@
 extern Atom _MOTIF_WM_HINTS;
 
 /*
- * Initialize module, no dependencies
+ * Declare our atoms with atoms_declare(); there is nothing else to
+ * initialize
  */
 
-void mwm_init();
+void mwm_declare_atoms();
 
 /*
  * This should be called whenever a client's _MOTIF_WM_HINTS property
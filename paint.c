@@ -32,6 +32,7 @@
 #include "malloc.h"
 #include "focus.h"
 #include "compat.h"
+#include "font.h"
 
 #include <stdio.h>
 
@@ -43,11 +44,18 @@
 #include "x.xbm"
 
 /*
- * Color allocation only happens on startup, so we don't have to be
- * too clever here.  Just use a simple array, realloc() when needed
- * and do linear search to look up entries.  When it matters, each
- * color is only a couple pointer indirections away.  Hilights are
- * calculated using a fixed offset.
+ * Colors are worked out whenever a client is mapped (prefs_apply()
+ * calls paint_calculate_colors()), so this has to be cheap.  Each
+ * color spec the user gives is resolved once and remembered, along
+ * with its hilights, in a small hash table.  On TrueColor visuals,
+ * pixel values are computed locally from the visual's masks instead
+ * of asking the server, so even the first lookup of a "#RRGGBB" spec
+ * doesn't need a round trip (color names still need one, once).
+ *
+ * Every distinct combination of pixels gets a row in the "colors"
+ * array, and clients only keep the index of their row.  Rows are
+ * found through a second hash table keyed by the normal and focused
+ * colors.  Hilights are calculated using a fixed offset.
  */
 
 enum {
@@ -63,6 +71,24 @@ enum {
 
 #define NCOLORS 8
 
+#define HASH_SIZE 64
+
+typedef struct _color_spec {
+    char *spec;
+    Bool ok;                    /* could parse spec? */
+    XColor exact;
+    unsigned long pixel;
+    Bool have_lights;           /* hilight and lolight worked out yet? */
+    unsigned long hilight;
+    unsigned long lolight;
+    struct _color_spec *next;
+} color_spec;
+
+typedef struct _channel {
+    int shift;
+    int bits;
+} channel;
+
 typedef struct _button {
     Pixmap pixmap;
     int width;
@@ -86,20 +112,43 @@ typedef struct _button {
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 #endif /* MIN */
 
+/* U+2026 HORIZONTAL ELLIPSIS if we can draw it */
+#define ELLIPSIS (font_utf8 ? "\342\200\246" : "...")
+
 
 
-static int find(unsigned long normal, unsigned long focused,
-                unsigned long text, unsigned long focused_text);
+static int find(unsigned long *row);
+static int add_row(unsigned long *row);
+static color_spec *lookup_spec(char *spec);
+static void spec_lights(color_spec *cs);
 static unsigned long calc(unsigned long orig, XColor exact, long offset,
                           char *color_text);
+static channel mask_channel(unsigned long mask);
+static unsigned long local_pixel(XColor *xc);
 
 int paint_ascent;
 
 static unsigned long *colors = NULL;  /* treated as a 2-D array */
 static int nallocated = 0;   /* dimension of "colors" is "nallocated" by 8 */
+static int *row_next = NULL; /* hash chains through "colors" */
+static int row_buckets[HASH_SIZE];
+
+static color_spec *specs[HASH_SIZE];
+
+/* TrueColor lets us compute pixels without the server */
+static Bool true_color;
+static channel red, green, blue;
+
+#define ROW_HASH(row) \
+    ((unsigned int)((row)[NORMAL] * 31 + (row)[FOCUSED]) % HASH_SIZE)
 
 static button *left_buttons;
 static button *right_buttons;
+static unsigned int button_serial = 1; /* bumped when buttons change */
+
+/* space taken by the buttons on each side, including borders */
+static int button_room_left = 4;
+static int button_room_right = 4;
 
 /*
  * Allocates default colors
@@ -107,25 +156,36 @@ static button *right_buttons;
 
 void paint_init() 
 {
-    colors = Malloc(sizeof(unsigned long) * NCOLORS);
-    if (colors == NULL) {
-        perror("AHWM: Failed to allocate default colors: malloc:");
-        fprintf(stderr, "AHWM: This is a fatal error, quitting.\n");
-        exit(1);
+    unsigned long defaults[NCOLORS];
+    Visual *visual;
+    int i;
+
+    visual = DefaultVisual(dpy, scr);
+    true_color = (visual->class == TrueColor);
+    if (true_color) {
+        red = mask_channel(visual->red_mask);
+        green = mask_channel(visual->green_mask);
+        blue = mask_channel(visual->blue_mask);
     }
 
-    nallocated = 1;
-    
+    for (i = 0; i < HASH_SIZE; i++)
+        row_buckets[i] = -1;
+
     /* default colors are black and white, no 3-D look */
     /* (this is index zero) */
-    colors[NORMAL] = black;
-    colors[HILIGHT] = black;
-    colors[LOLIGHT] = black;
-    colors[TEXT] = white;
-    colors[FOCUSED] = white;
-    colors[FOCUSED_HILIGHT] = white;
-    colors[FOCUSED_LOLIGHT] = white;
-    colors[FOCUSED_TEXT] = black;
+    defaults[NORMAL] = black;
+    defaults[HILIGHT] = black;
+    defaults[LOLIGHT] = black;
+    defaults[TEXT] = white;
+    defaults[FOCUSED] = white;
+    defaults[FOCUSED_HILIGHT] = white;
+    defaults[FOCUSED_LOLIGHT] = white;
+    defaults[FOCUSED_TEXT] = black;
+    if (add_row(defaults) != 0) {
+        perror("AHWM: Failed to allocate default colors: malloc:");
+        fprintf(stderr, "AHWM: This is a fatal error, quitting.\n");
+        exit(1);
+    }
 }
 
 void paint_add_button(char *image, Bool left)
@@ -170,6 +230,11 @@ void paint_add_button(char *image, Bool left)
         
     b->pixmap = XCreateBitmapFromData(dpy, root_window, (char *)bits,
                                       b->width, b->height);
+    button_serial++;
+    if (left)
+        button_room_left += b->width + 4;
+    else
+        button_room_right += b->width + 4;
 
     if (left) {
         if (left_buttons == NULL) {
@@ -196,22 +261,103 @@ void paint_add_button(char *image, Bool left)
 }
 
 /* see if values already seen */
-static int find(unsigned long normal, unsigned long focused,
-                unsigned long text, unsigned long focused_text)
+static int find(unsigned long *row)
 {
     int i;
 
-    for (i = 0; i < nallocated; i++) {
-        if (normal == colors[i*NCOLORS + NORMAL] &&
-            focused == colors[i*NCOLORS + FOCUSED] &&
-            text == colors[i*NCOLORS + TEXT] &&
-            focused_text == colors[i*NCOLORS + FOCUSED_TEXT]) {
+    for (i = row_buckets[ROW_HASH(row)]; i != -1; i = row_next[i]) {
+        if (memcmp(&colors[i * NCOLORS], row,
+                   NCOLORS * sizeof(unsigned long)) == 0) {
             return i;
         }
     }
     return -1;
 }
 
+/* returns index of new row, or -1 */
+static int add_row(unsigned long *row)
+{
+    unsigned long *tmp;
+    int *tmp_next;
+    unsigned int h;
+
+    tmp = Realloc(colors, (nallocated + 1) * NCOLORS * sizeof(unsigned long));
+    if (tmp == NULL) return -1;
+    colors = tmp;
+    tmp_next = Realloc(row_next, (nallocated + 1) * sizeof(int));
+    if (tmp_next == NULL) return -1;
+    row_next = tmp_next;
+
+    memcpy(&colors[nallocated * NCOLORS], row,
+           NCOLORS * sizeof(unsigned long));
+    h = ROW_HASH(row);
+    row_next[nallocated] = row_buckets[h];
+    row_buckets[h] = nallocated;
+    return nallocated++;
+}
+
+/*
+ * Finds the pixel for a color spec, resolving it the first time we
+ * see it.  Specs we can't parse are remembered too, so we only
+ * complain about them once.
+ */
+
+static color_spec *lookup_spec(char *spec)
+{
+    color_spec *cs;
+    XColor usable;
+    unsigned int h;
+    char *cp;
+
+    h = 0;
+    for (cp = spec; *cp != '\0'; cp++)
+        h = h * 31 + (unsigned char)*cp;
+    h %= HASH_SIZE;
+    
+    for (cs = specs[h]; cs != NULL; cs = cs->next) {
+        if (strcmp(cs->spec, spec) == 0)
+            return cs;
+    }
+
+    cs = Malloc(sizeof(color_spec));
+    if (cs == NULL) {
+        perror("AHWM: lookup_spec: malloc");
+        return NULL;
+    }
+    cs->spec = Strdup(spec);
+    if (cs->spec == NULL) {
+        perror("AHWM: lookup_spec: strdup");
+        Free(cs);
+        return NULL;
+    }
+    cs->have_lights = False;
+
+    if (true_color) {
+        /* parsed locally unless it's a color name */
+        cs->ok = XParseColor(dpy, DefaultColormap(dpy, scr),
+                             spec, &cs->exact);
+        if (cs->ok) cs->pixel = local_pixel(&cs->exact);
+    } else {
+        cs->ok = XAllocNamedColor(dpy, DefaultColormap(dpy, scr), spec,
+                                  &usable, &cs->exact);
+        if (cs->ok) cs->pixel = usable.pixel;
+    }
+    if (!cs->ok)
+        fprintf(stderr, "AHWM: Could not get color \"%s\"\n", spec);
+
+    cs->next = specs[h];
+    specs[h] = cs;
+    return cs;
+}
+
+static void spec_lights(color_spec *cs)
+{
+    if (cs->have_lights) return;
+    cs->hilight = calc(cs->pixel, cs->exact, OFFSET, cs->spec);
+    cs->lolight = calc(cs->pixel, cs->exact, -OFFSET, cs->spec);
+    cs->have_lights = True;
+}
+
 /*
  * calculates hilights given original color pixel value, an "exact"
  * XColor value, etc.  This is kind of ugly, but the behaviour is
@@ -232,6 +378,8 @@ static unsigned long calc(unsigned long orig, XColor exact, long offset,
         usable.green = ADD(exact.green, OFFSET);
         usable.blue = ADD(exact.blue, OFFSET);
     }
+    if (true_color)
+        return local_pixel(&usable);
     if (XAllocColor(dpy, DefaultColormap(dpy, scr), &usable) == 0) {
         fprintf(stderr,
                 "AHWM: Could not allocate %shighlight of color \"%s\"\n",
@@ -242,66 +390,70 @@ static unsigned long calc(unsigned long orig, XColor exact, long offset,
     return usable.pixel;
 }
 
+static channel mask_channel(unsigned long mask)
+{
+    channel c;
+
+    c.shift = c.bits = 0;
+    if (mask == 0) return c;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        c.shift++;
+    }
+    while ((mask & 1) != 0) {
+        mask >>= 1;
+        c.bits++;
+    }
+    if (c.bits > 16) {
+        /* more precision than XColor has */
+        c.shift += c.bits - 16;
+        c.bits = 16;
+    }
+    return c;
+}
+
+/* what the server would give us for XAllocColor() on a TrueColor visual */
+static unsigned long local_pixel(XColor *xc)
+{
+    return ((unsigned long)(xc->red >> (16 - red.bits)) << red.shift)
+        | ((unsigned long)(xc->green >> (16 - green.bits)) << green.shift)
+        | ((unsigned long)(xc->blue >> (16 - blue.bits)) << blue.shift);
+}
+
 void paint_calculate_colors(client_t *client, char *normal,
                             char *focused, char *text, char *focused_text)
 {
     int i;
     unsigned long new_dquad[NCOLORS];
-    unsigned long *tmp;
-    XColor xc_normal, xc_focused;
-    XColor usable, exact;
+    color_spec *cs;
 
     /* set defaults (using index zero of colors array) */
     memcpy(&new_dquad, colors, NCOLORS * sizeof(unsigned long));
 
-    xc_normal.red = 0xFFFF;
-    xc_normal.blue = 0xFFFF;
-    xc_normal.green = 0xFFFF;
-    xc_focused.red = 0;
-    xc_focused.blue = 0;
-    xc_focused.green = 0;
-
     debug(("\tColors:  %s, %s, %s, %s\n", normal, focused, text, focused_text));
     
-    /* parse four given colors, save "exact" representation */
-    if (normal != NULL) {
-        if (XAllocNamedColor(dpy, DefaultColormap(dpy, scr), normal,
-                             &usable, &exact) == 0) {
-            fprintf(stderr, "AHWM: Could not get color \"%s\"\n", normal);
-        } else {
-            new_dquad[NORMAL] = usable.pixel;
-            xc_normal = exact;
-        }
+    if (normal != NULL && (cs = lookup_spec(normal)) != NULL && cs->ok) {
+        spec_lights(cs);
+        new_dquad[NORMAL] = cs->pixel;
+        new_dquad[HILIGHT] = cs->hilight;
+        new_dquad[LOLIGHT] = cs->lolight;
     }
-    if (focused != NULL) {
-        if (XAllocNamedColor(dpy, DefaultColormap(dpy, scr), focused,
-                             &usable, &exact) == 0) {
-            fprintf(stderr, "AHWM: Could not get color \"%s\"\n", focused);
-        } else {
-            new_dquad[FOCUSED] = usable.pixel;
-            xc_focused = exact;
-        }
+    if (focused != NULL && (cs = lookup_spec(focused)) != NULL && cs->ok) {
+        spec_lights(cs);
+        new_dquad[FOCUSED] = cs->pixel;
+        new_dquad[FOCUSED_HILIGHT] = cs->hilight;
+        new_dquad[FOCUSED_LOLIGHT] = cs->lolight;
     }
-    if (text != NULL) {
-        if (XAllocNamedColor(dpy, DefaultColormap(dpy, scr), text,
-                             &usable, &exact) == 0) {
-            fprintf(stderr, "AHWM: Could not get color \"%s\"\n", text);
-        } else {
-            new_dquad[TEXT] = usable.pixel;
-        }
+    if (text != NULL && (cs = lookup_spec(text)) != NULL && cs->ok) {
+        new_dquad[TEXT] = cs->pixel;
     }
-    if (focused_text != NULL) {
-        if (XAllocNamedColor(dpy, DefaultColormap(dpy, scr), focused_text,
-                             &usable, &exact) == 0) {
-            fprintf(stderr, "AHWM: Could not get color \"%s\"\n", focused_text);
-        } else {
-            new_dquad[FOCUSED_TEXT] = usable.pixel;
-        }
+    if (focused_text != NULL
+        && (cs = lookup_spec(focused_text)) != NULL && cs->ok) {
+        new_dquad[FOCUSED_TEXT] = cs->pixel;
     }
 
     /* see if already know combination */
-    i = find(new_dquad[NORMAL], new_dquad[FOCUSED],
-             new_dquad[TEXT], new_dquad[FOCUSED_TEXT]);
+    i = find(new_dquad);
     if (i != -1) {
         client->color_index = i;
         debug(("\tColor index found: %d\n", i));
@@ -309,41 +461,86 @@ void paint_calculate_colors(client_t *client, char *normal,
     }
 
     /* allocate another entry */
-    tmp = Realloc(colors, (nallocated + 1) * NCOLORS * sizeof(unsigned long));
-    if (tmp == NULL) {
+    i = add_row(new_dquad);
+    if (i == -1) {
         perror("AHWM:  realloc:");
         client->color_index = 0;
         return;
     }
-    colors = tmp;
+    client->color_index = i;
+    debug(("\tAllocated new color entry: %d\n", i));
+    /* the titlebar image is keyed on color_index, so the next
+     * paint_titlebar() redraws it */
+}
 
-    /* calculate the hilights */
-    new_dquad[HILIGHT] = calc(new_dquad[NORMAL], xc_normal, OFFSET, normal);
-    new_dquad[LOLIGHT] = calc(new_dquad[NORMAL], xc_normal, -OFFSET, normal);
-    new_dquad[FOCUSED_HILIGHT] = calc(new_dquad[FOCUSED], xc_focused,
-                                      OFFSET, focused);
-    new_dquad[FOCUSED_LOLIGHT] = calc(new_dquad[FOCUSED], xc_focused,
-                                      -OFFSET, focused);
+/*
+ * Works out how much of the title fits between the buttons, cutting
+ * it short with an ellipsis if needed, and where it goes.  Measuring
+ * text is the expensive part of painting, so the result is kept in
+ * the client until the name (see paint_titlebar_invalidate()), the
+ * width, the button layout or the title position changes.
+ */
 
-    memcpy(&colors[nallocated * NCOLORS],
-           &new_dquad,
-           NCOLORS * sizeof(unsigned long));
-    client->color_index = nallocated++;
-    debug(("\tAllocated new color entry: %d\n", nallocated-1));
-    /* FIXME:  should investigate changing window's background
-     * color in case X decides to show that at some point */
-    /* FIXME:  might also need to repaint right now */
+static title_layout *paint_layout(client_t *client)
+{
+    title_layout *tl;
+    int ellipsis_width, room;
+
+    tl = &client->title_layout;
+    room = client->width - button_room_left - button_room_right;
+    if (room < 0) room = 0;
+    if (tl->valid && tl->room == room
+        && tl->position == client->title_position
+        && tl->room_left == button_room_left) {
+        return tl;
+    }
+
+    if (!tl->valid) {
+        tl->name_len = strlen(client->name);
+        tl->width = font_width(client->name, tl->name_len);
+        tl->valid = True;
+    }
+    tl->room = room;
+    tl->room_left = button_room_left;
+    tl->position = client->title_position;
+
+    if (tl->width <= room) {
+        tl->len = tl->name_len;
+        tl->len_width = tl->shown_width = tl->width;
+        tl->ellipsized = False;
+    } else {
+        ellipsis_width = font_width(ELLIPSIS, strlen(ELLIPSIS));
+        tl->len = font_fit(client->name, tl->name_len,
+                           MAX(room - ellipsis_width, 0), &tl->len_width);
+        tl->shown_width = tl->len_width + ellipsis_width;
+        tl->ellipsized = True;
+    }
+
+    /* the title never obscures the buttons */
+    if (client->title_position == DisplayLeft) {
+        tl->x = button_room_left;
+    } else if (client->title_position == DisplayCentered) {
+        tl->x = button_room_left + (room - tl->shown_width) / 2;
+    } else if (client->title_position == DisplayRight) {
+        tl->x = button_room_left + room - tl->shown_width;
+    } else {
+        fprintf(stderr, "AHWM: Unkown client title position %d on client %s\n",
+                client->title_position, client_dbg(client));
+        /* possible memory corruption, attempt to continue */
+        tl->x = button_room_left;
+    }
+    return tl;
 }
 
 /* this is one of the few functions that is speed-critical, so it looks
  * a bit ugly because it's somewhat optimized
  * we use line segments because we want to reduce the number of calls
  * to xlib (xlib calls can be very expensive) */
-void paint_titlebar(client_t *client)
+static void paint_render(client_t *client, Drawable d, Bool focused)
 {
     unsigned long middle, hilight, lowlight, text;
     XGCValues xgcv;
-    int ndx, title_position, room_left, room_right, tmp;
+    int ndx, room_left, room_right, tmp;
     button *b;
     static XSegment *button_hilights = NULL, *button_lolights = NULL;
     static int nbutton_hilights = 0;
@@ -355,9 +552,8 @@ void paint_titlebar(client_t *client)
         { 1, 1, 1, 1 }, { 2, 2, 2, 2 },
         { 1, 1, 1, 1 }, { 2, 2, 2, 2 } };
     XSegment *tmp_segptr;
+    title_layout *tl;
     
-    if (client == NULL || client->titlebar == None) return;
-
     ndx = client->color_index;
     debug(("\tColor index = %d, nallocated = %d\n", ndx, nallocated));
     if (ndx >= nallocated) {
@@ -367,7 +563,7 @@ void paint_titlebar(client_t *client)
         ndx = 0;
     }
     
-    if (client == focus_current && client->focus_policy != DontFocus) {
+    if (focused) {
         middle = colors[ndx * NCOLORS + FOCUSED];
         hilight = colors[ndx * NCOLORS + FOCUSED_HILIGHT];
         lowlight = colors[ndx * NCOLORS + FOCUSED_LOLIGHT];
@@ -378,6 +574,10 @@ void paint_titlebar(client_t *client)
         lowlight = colors[ndx * NCOLORS + LOLIGHT];
         text = colors[ndx * NCOLORS + TEXT];
     }
+    /* grey out the title of a hung client; kill.c repaints us */
+    if (client->unresponsive) {
+        text = lowlight;
+    }
 
     /* using four different GCs instead of using one and
      * continually changing its values may or may not be faster
@@ -395,7 +595,7 @@ void paint_titlebar(client_t *client)
     xgcv.background = middle;
     XChangeGC(dpy, extra_gc4, GCForeground | GCBackground, &xgcv);
     
-    XFillRectangle(dpy, client->titlebar, extra_gc1,
+    XFillRectangle(dpy, d, extra_gc1,
                    0, 0, client->width, TITLE_HEIGHT);
 
     /* the commented-out assignments happen only once,
@@ -444,14 +644,14 @@ void paint_titlebar(client_t *client)
     room_left = room_right = 2;
     nhilights_used = 0;
     for (b = left_buttons; b != NULL; b = b->next) {
-        XCopyPlane(dpy, b->pixmap, client->titlebar, extra_gc4, 0, 0,
+        XCopyPlane(dpy, b->pixmap, d, extra_gc4, 0, 0,
                    b->width, MIN(b->height, TITLE_HEIGHT - 4),
                    room_left, 2, 1);
         if (nbutton_hilights <= nhilights_used) {
             tmp_segptr = Realloc(button_hilights,
                                  (nbutton_hilights + 2) * sizeof(XSegment));
             if (tmp_segptr == NULL) {
-                perror("AHWM: paint_titlebar: realloc");
+                perror("AHWM: paint_render: realloc");
                 continue;
             } else {
                 button_hilights = tmp_segptr;
@@ -459,7 +659,7 @@ void paint_titlebar(client_t *client)
             tmp_segptr = Realloc(button_lolights,
                                  (nbutton_hilights + 2) * sizeof(XSegment));
             if (tmp_segptr == NULL) {
-                perror("AHWM: paint_titlebar: realloc");
+                perror("AHWM: paint_render: realloc");
                 continue;
             } else {
                 button_lolights = tmp_segptr;
@@ -471,35 +671,35 @@ void paint_titlebar(client_t *client)
         tmp = room_left + b->width;
         room_left += b->width + 4;
 
-        button_lolights[nbutton_hilights - 2].x1 = tmp;
-        button_lolights[nbutton_hilights - 2].y1 = 2;
-        button_lolights[nbutton_hilights - 2].x2 = tmp;
-        button_lolights[nbutton_hilights - 2].y2 = TITLE_HEIGHT - 2;
+        button_lolights[nhilights_used - 2].x1 = tmp;
+        button_lolights[nhilights_used - 2].y1 = 2;
+        button_lolights[nhilights_used - 2].x2 = tmp;
+        button_lolights[nhilights_used - 2].y2 = TITLE_HEIGHT - 2;
         tmp++;
-        button_lolights[nbutton_hilights - 1].x1 = tmp;
-        button_lolights[nbutton_hilights - 1].y1 = 1;
-        button_lolights[nbutton_hilights - 1].x2 = tmp;
-        button_lolights[nbutton_hilights - 1].y2 = TITLE_HEIGHT - 2;
+        button_lolights[nhilights_used - 1].x1 = tmp;
+        button_lolights[nhilights_used - 1].y1 = 1;
+        button_lolights[nhilights_used - 1].x2 = tmp;
+        button_lolights[nhilights_used - 1].y2 = TITLE_HEIGHT - 2;
         tmp++;
-        button_hilights[nbutton_hilights - 2].x1 = tmp;
-        button_hilights[nbutton_hilights - 2].y1 = 0;
-        button_hilights[nbutton_hilights - 2].x2 = tmp;
-        button_hilights[nbutton_hilights - 2].y2 = TITLE_HEIGHT;
+        button_hilights[nhilights_used - 2].x1 = tmp;
+        button_hilights[nhilights_used - 2].y1 = 0;
+        button_hilights[nhilights_used - 2].x2 = tmp;
+        button_hilights[nhilights_used - 2].y2 = TITLE_HEIGHT;
         tmp++;
-        button_hilights[nbutton_hilights - 1].x1 = tmp;
-        button_hilights[nbutton_hilights - 1].y1 = 1;
-        button_hilights[nbutton_hilights - 1].x2 = tmp;
-        button_hilights[nbutton_hilights - 1].y2 = TITLE_HEIGHT - 2;
+        button_hilights[nhilights_used - 1].x1 = tmp;
+        button_hilights[nhilights_used - 1].y1 = 1;
+        button_hilights[nhilights_used - 1].x2 = tmp;
+        button_hilights[nhilights_used - 1].y2 = TITLE_HEIGHT - 2;
     }
     for (b = right_buttons; b != NULL; b = b->next) {
-        XCopyPlane(dpy, b->pixmap, client->titlebar, extra_gc4, 0, 0,
+        XCopyPlane(dpy, b->pixmap, d, extra_gc4, 0, 0,
                    b->width, MIN(b->height, TITLE_HEIGHT - 4),
                    client->width - room_right - b->width, 2, 1);
         if (nbutton_hilights <= nhilights_used) {
             tmp_segptr = Realloc(button_hilights,
                                  (nbutton_hilights + 2) * sizeof(XSegment));
             if (tmp_segptr == NULL) {
-                perror("AHWM: paint_titlebar: realloc");
+                perror("AHWM: paint_render: realloc");
                 continue;
             } else {
                 button_hilights = tmp_segptr;
@@ -507,7 +707,7 @@ void paint_titlebar(client_t *client)
             tmp_segptr = Realloc(button_lolights,
                                  (nbutton_hilights + 2) * sizeof(XSegment));
             if (tmp_segptr == NULL) {
-                perror("AHWM: paint_titlebar: realloc");
+                perror("AHWM: paint_render: realloc");
                 continue;
             } else {
                 button_lolights = tmp_segptr;
@@ -541,39 +741,170 @@ void paint_titlebar(client_t *client)
         button_lolights[nhilights_used - 1].y2 = TITLE_HEIGHT - 2;
     }
 
-    room_left += 2;
-    room_right += 2;
-    
-    if (client->title_position == DisplayLeft) {
-        title_position = room_left;
-    } else if (client->title_position == DisplayCentered) {
-        int i = XTextWidth(fontstruct, client->name, strlen(client->name));
-        title_position = (client->width - room_left - room_right) / 2 - i / 2;
-        title_position += room_left;
-        if (title_position + i > client->width - room_right) {
-            /* don't want title to obscure buttons */
-            title_position -= title_position + i - (client->width - room_right);
-        }
-    } else if (client->title_position == DisplayRight) {
-        int i = XTextWidth(fontstruct, client->name, strlen(client->name));
-        title_position = client->width - i - room_right;
-    } else {
-        fprintf(stderr, "AHWM: Unkown client title position %d on client %s\n",
-                client->title_position, client_dbg(client));
-        /* possible memory corruption, attempt to continue */
-        title_position = room_left;
-    }
-    XDrawSegments(dpy, client->titlebar, extra_gc2,
+    XDrawSegments(dpy, d, extra_gc2,
                   main_hilight, 4);
-    XDrawSegments(dpy, client->titlebar, extra_gc3,
+    XDrawSegments(dpy, d, extra_gc3,
                   main_lolight, 4);
 
     if (client->title_position != DontDisplay) {
-        XDrawString(dpy, client->titlebar, extra_gc4, title_position,
-                    paint_ascent, client->name, strlen(client->name));
+        tl = paint_layout(client);
+        font_draw(d, extra_gc4, text, tl->x, paint_ascent,
+                  client->name, tl->len);
+        if (tl->ellipsized) {
+            font_draw(d, extra_gc4, text, tl->x + tl->len_width,
+                      paint_ascent, ELLIPSIS, strlen(ELLIPSIS));
+        }
     }
-    XDrawSegments(dpy, client->titlebar, extra_gc2,
+    XDrawSegments(dpy, d, extra_gc2,
                   button_hilights, nhilights_used);
-    XDrawSegments(dpy, client->titlebar, extra_gc3,
+    XDrawSegments(dpy, d, extra_gc3,
                   button_lolights, nhilights_used);
 }
+
+/*
+ * Each client keeps two pixmaps holding the rendered titlebar, one
+ * for the unfocused and one for the focused look.  The current one
+ * is installed as the titlebar's background, so a focus change is
+ * just a background swap and the server repaints exposed areas
+ * itself without a round trip through us.  We only render again
+ * when something the image depends on changes: the width, colors,
+ * title position or button layout (checked here) or the title text
+ * (callers tell us with paint_titlebar_invalidate()).
+ *
+ * The pixmaps are allocated a little wider than needed so that an
+ * interactive resize doesn't reallocate them on every step.
+ *
+ * Expose events are collected per titlebar with
+ * paint_titlebar_damage() and handled once per series with
+ * paint_titlebar_repair(), which usually has nothing left to do.
+ */
+
+#define PIXMAP_SLACK 128
+
+static void free_pixmaps(title_cache *tc);
+
+void paint_titlebar(client_t *client)
+{
+    paint_titlebar_clip(client, NULL);
+}
+
+void paint_titlebar_clip(client_t *client, Region clip)
+{
+    title_cache *tc;
+    int focused, width;
+    Bool changed;
+    Pixmap previous;
+    XRectangle r;
+
+    if (client == NULL || client->titlebar == None) return;
+
+    tc = &client->title_cache;
+    if (tc->width != client->width
+        || tc->color_index != client->color_index
+        || tc->title_position != client->title_position
+        || tc->buttons != button_serial) {
+        /* the title layout checks these itself */
+        tc->valid[0] = tc->valid[1] = False;
+        tc->width = client->width;
+        tc->color_index = client->color_index;
+        tc->title_position = client->title_position;
+        tc->buttons = button_serial;
+    }
+
+    if (tc->pixmap_width < client->width) {
+        free_pixmaps(tc);
+        width = (client->width + PIXMAP_SLACK) & ~(PIXMAP_SLACK - 1);
+        tc->pixmap[0] = XCreatePixmap(dpy, client->titlebar, width,
+                                      TITLE_HEIGHT, DefaultDepth(dpy, scr));
+        tc->pixmap[1] = XCreatePixmap(dpy, client->titlebar, width,
+                                      TITLE_HEIGHT, DefaultDepth(dpy, scr));
+        tc->pixmap_width = width;
+    }
+
+    focused = (client == focus_current && client->focus_policy != DontFocus);
+    previous = tc->installed;
+    changed = False;
+    if (!tc->valid[focused]) {
+        paint_render(client, tc->pixmap[focused], focused);
+        tc->valid[focused] = True;
+        changed = True;
+        /* The server may have copied the old contents when the pixmap
+         * became the background, and what drawing into it afterwards
+         * does to the window is undefined, so install it again. */
+        if (tc->installed == tc->pixmap[focused]) tc->installed = None;
+    }
+    if (tc->installed != tc->pixmap[focused]) {
+        XSetWindowBackgroundPixmap(dpy, client->titlebar, tc->pixmap[focused]);
+        tc->installed = tc->pixmap[focused];
+        changed = True;
+    }
+    if (!changed) {
+        /* the server already repainted any exposed areas */
+        return;
+    }
+    if (clip != NULL && previous == None) {
+        /* Nothing of ours was on the screen yet, so only the damaged
+         * part needs clearing to the new background; the server will
+         * paint the rest from it when it is exposed.  The image
+         * itself is always rendered whole. */
+        XClipBox(clip, &r);
+        XClearArea(dpy, client->titlebar, r.x, r.y, r.width, r.height, False);
+    } else {
+        XClearWindow(dpy, client->titlebar);
+    }
+}
+
+void paint_titlebar_damage(client_t *client, XRectangle *r)
+{
+    title_cache *tc;
+
+    if (client == NULL || client->titlebar == None) return;
+    tc = &client->title_cache;
+    if (tc->damage == NULL) {
+        tc->damage = XCreateRegion();
+        if (tc->damage == NULL) return;
+    }
+    XUnionRectWithRegion(r, tc->damage, tc->damage);
+}
+
+void paint_titlebar_repair(client_t *client)
+{
+    title_cache *tc;
+
+    if (client == NULL || client->titlebar == None) return;
+    tc = &client->title_cache;
+    if (tc->damage == NULL || XEmptyRegion(tc->damage)) return;
+    paint_titlebar_clip(client, tc->damage);
+    XSubtractRegion(tc->damage, tc->damage, tc->damage);
+}
+
+void paint_titlebar_invalidate(client_t *client)
+{
+    if (client == NULL) return;
+    client->title_layout.valid = False;
+    client->title_cache.valid[0] = False;
+    client->title_cache.valid[1] = False;
+}
+
+void paint_titlebar_release(client_t *client)
+{
+    title_cache *tc;
+
+    if (client == NULL) return;
+    tc = &client->title_cache;
+    free_pixmaps(tc);
+    if (tc->damage != NULL) {
+        XDestroyRegion(tc->damage);
+        tc->damage = NULL;
+    }
+}
+
+static void free_pixmaps(title_cache *tc)
+{
+    /* the server holds on to an installed background itself */
+    if (tc->pixmap[0] != None) XFreePixmap(dpy, tc->pixmap[0]);
+    if (tc->pixmap[1] != None) XFreePixmap(dpy, tc->pixmap[1]);
+    tc->pixmap[0] = tc->pixmap[1] = tc->installed = None;
+    tc->pixmap_width = 0;
+    tc->valid[0] = tc->valid[1] = False;
+}
@@ -88,8 +88,44 @@ void paint_add_button(char *image, Bool left);
 /*
  * Paints the titlebar.  All of it.  At once.
  * Also adds a 3-D hilights if user specified colors for the titlebar.
+ * The result is cached in the titlebar's background pixmap, so
+ * calling this when nothing has changed costs nothing.
  */
 
 void paint_titlebar(client_t *client);
 
+/*
+ * Like paint_titlebar(), but only the area in CLIP is known to be
+ * damaged.  CLIP may be NULL, meaning all of it.  The titlebar image
+ * is still rendered whole; CLIP only limits what is cleared to the
+ * background the first time one is installed.
+ */
+
+void paint_titlebar_clip(client_t *client, Region clip);
+
+/*
+ * Exposures: paint_titlebar_damage() records an exposed rectangle of
+ * the titlebar, and paint_titlebar_repair() repaints everything
+ * recorded since the last repair, once.
+ */
+
+void paint_titlebar_damage(client_t *client, XRectangle *r);
+void paint_titlebar_repair(client_t *client);
+
+/*
+ * Call this after changing client->name by hand (client_set_name()
+ * does it for you); the next paint_titlebar() will measure and
+ * redraw the title.  Changes to anything else are noticed by
+ * paint_titlebar() itself.
+ */
+
+void paint_titlebar_invalidate(client_t *client);
+
+/*
+ * Frees the cached titlebar images and damage.  Call before
+ * destroying the titlebar window.
+ */
+
+void paint_titlebar_release(client_t *client);
+
 #endif /* PAINT_H */
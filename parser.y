@@ -71,6 +71,10 @@
 %token TOK_RAISEDELAY
 %token TOK_USENETWMPID
 %token TOK_WINDOWKILLINGPATIENCE
+%token TOK_ANIMATIONLENGTH
+%token TOK_ANIMATIONFRAMERATE
+%token TOK_FOCUSSETTLETIME
+%token TOK_ROUNDTRIPBUDGET
 
 %token TOK_SLOPPY_FOCUS
 %token TOK_CLICK_TO_FOCUS
@@ -284,6 +288,10 @@ option_name: TOK_DISPLAYTITLEBAR { $$ = DISPLAYTITLEBAR; }
            | TOK_RAISEDELAY { $$ = RAISEDELAY; }
            | TOK_USENETWMPID { $$ = USENETWMPID; }
            | TOK_WINDOWKILLINGPATIENCE { $$ = KILLINGPATIENCE; }
+           | TOK_ANIMATIONLENGTH { $$ = ANIMATIONLENGTH; }
+           | TOK_ANIMATIONFRAMERATE { $$ = ANIMATIONFRAMERATE; }
+           | TOK_FOCUSSETTLETIME { $$ = FOCUSSETTLETIME; }
+           | TOK_ROUNDTRIPBUDGET { $$ = ROUNDTRIPBUDGET; }
            ;
 
 type: boolean
@@ -0,0 +1,165 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "place-core.h"
+
+#ifndef MIN
+#define MIN(x,y) ((x) < (y) ? (x) : (y))
+#endif
+#ifndef MAX
+#define MAX(x,y) ((x) > (y) ? (x) : (y))
+#endif
+
+int place_corner_free(place_rect *rects, int n, int x, int y)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (rects[i].x <= x
+            && rects[i].y <= y
+            && rects[i].x + rects[i].width >= x
+            && rects[i].y + rects[i].height >= y)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Finds the overlap between two rectangles.
+ * 
+ * The overlap between a newly-mapped window and all existing clients
+ * is found by simply summing the result of this function across the
+ * new window crossed with all existing windows.  This is not the
+ * correct overlap as it counts some overlaps twice if the existing
+ * windows were already overlapping under the new position.  However,
+ * finding the "correct" overlap takes too much time, and in practice,
+ * this actually "feels" better.
+ */
+
+static int find_overlap(place_rect *one, place_rect *two)
+{
+    int x1, x2, y1, y2;
+
+    x1 = MAX(one->x, two->x);
+    x2 = MIN(one->x + one->width, two->x + two->width);
+    if (x2 - x1 <= 0) return 0;
+    y1 = MAX(one->y, two->y);
+    y2 = MIN(one->y + one->height, two->y + two->height);
+    if (y2 - y1 <= 0) return 0;
+    return (y2 - y1) * (x2 - x1);
+}
+
+/*
+ * Algorithm works as follows:
+ * 
+ * For each client A
+ *     y = A.top
+ *     For each client B
+ *         x = B.left
+ *         Try to place at x, y
+ *         x = B.right
+ *         Try to place at x, y
+ *     y = A.bottom
+ *     For each client B
+ *         x = B.left
+ *         Try to place at x, y
+ *         x = B.right
+ *         Try to place at x, y
+ * 
+ * The position that wins is the position that creates the least
+ * amount of overlap in the windows.  Ties are settled by least y,
+ * then by least x.  The actual code looks a bit different because the
+ * 'Try to place' step includes calculating the overlap, which is
+ * expensive.  This is only called when each of the four corners has a
+ * window in it, so we examine the sides of the screen just as we
+ * examine the sides of each window.
+ * 
+ * This algorithm is "correct" in that it will choose the position
+ * with the least amount of overlap out of all the possible positions.
+ * However, the "overlap" is calculated incorrectly (see above).
+ * 
+ * Other window managers use a similar algorithm (perhaps with some
+ * additional steps to shortcut if a zero-overlap position is found)
+ * or they use some heuristic that's a bit faster but doesn't satisfy
+ * the least overlap condition.  The triple-loop looks ugly, but it
+ * runs in favorable time on every slow machine that I've tried (there
+ * are no function calls in any of this, this is just straight
+ * calculation).
+ * 
+ * FIXME:  need to test this on a slower machine (like a 486 or
+ * pentium 1), works fine on all my machines, but I still don't feel
+ * OK with it
+ */
+
+void place_least_overlap(place_rect *rects, int n, place_rect *window,
+                         int scr_width, int scr_height)
+{
+    int overlap_final, x_final, y_final, overlap_test, x_test, y_test;
+    int max_x, max_y;
+    int a, b, c;
+
+    max_x = scr_width - window->width;
+    max_y = scr_height - window->height;
+    overlap_final = -1;         /* nothing tried yet */
+    x_final = window->x;
+    y_final = window->y;
+
+    /* even A and B are the top and left edges, odd the bottom and right */
+    for (a = 0; a < 2 * n; a++) {
+        y_test = rects[a / 2].y;
+        if (a % 2 == 1) y_test += rects[a / 2].height;
+        if (y_test < 0 || y_test > max_y) continue;
+        
+        for (b = 0; b < 2 * n; b++) {
+            x_test = rects[b / 2].x;
+            if (b % 2 == 1) x_test += rects[b / 2].width;
+            if (x_test < 0 || x_test > max_x) continue;
+
+            /* calculate the overlap */
+            overlap_test = 0;
+            window->x = x_test;
+            window->y = y_test;
+            for (c = 0; c < n; c++) {
+                overlap_test += find_overlap(&rects[c], window);
+            }
+            /* set the final x, y to the x, y which have the smallest
+             * overlap, sorted by y then by x */
+            if (overlap_final < 0
+                || overlap_test < overlap_final
+                || (overlap_test == overlap_final
+                    && (y_test < y_final
+                        || (y_test == y_final
+                            && x_test < x_final)))) {
+                overlap_final = overlap_test;
+                x_final = x_test;
+                y_final = y_test;
+            }
+        }
+    }
+    window->x = x_final;
+    window->y = y_final;
+}
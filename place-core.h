@@ -0,0 +1,58 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The arithmetic behind window placement (see place.h), done on plain
+ * rectangles so that it can be run and timed without an X server.
+ */
+
+#ifndef PLACE_CORE_H
+#define PLACE_CORE_H
+
+#include "config.h"
+
+typedef struct _place_rect {
+    int x, y;
+    int width, height;
+} place_rect;
+
+/*
+ * Returns 1 if none of the N rectangles in RECTS covers the point X,
+ * Y (edges included), 0 otherwise.
+ */
+
+int place_corner_free(place_rect *rects, int n, int x, int y);
+
+/*
+ * Moves WINDOW to the spot on a SCR_WIDTH by SCR_HEIGHT screen where
+ * it overlaps the N rectangles in RECTS the least, trying only spots
+ * lined up with the edges of the rectangles.  WINDOW is left alone if
+ * no such spot keeps it on the screen.
+ */
+
+void place_least_overlap(place_rect *rects, int n, place_rect *window,
+                         int scr_width, int scr_height);
+
+#endif /* PLACE_CORE_H */
@@ -0,0 +1,225 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pool.h"
+#include "malloc.h"
+
+#define POOL_GRAIN 16           /* size classes are this far apart */
+#define POOL_NCLASSES (POOL_MAX / POOL_GRAIN)
+#define POOL_SLAB 4096          /* what we ask malloc for at once */
+#define ARENA_MIN 64            /* smallest arena block */
+
+typedef struct _free_object {
+    struct _free_object *next;
+} free_object;
+
+typedef struct _size_class {
+    free_object *free;          /* LIFO, so recently used memory */
+    unsigned long slabs;
+    unsigned long in_use;
+    unsigned long peak;
+    unsigned long allocs;       /* since startup */
+} size_class;
+
+static size_class classes[POOL_NCLASSES];
+static unsigned long large_in_use = 0;
+static unsigned long large_allocs = 0;
+static unsigned long arena_blocks = 0;
+static unsigned long arena_bytes = 0;
+static unsigned long arena_compactions = 0;
+
+void *pool_alloc(size_t size)
+{
+    size_class *c;
+    free_object *obj;
+    char *slab;
+    int i, n, object_size;
+
+    if (size == 0) size = 1;
+    if (size > POOL_MAX) {
+        obj = Malloc(size);
+        if (obj != NULL) {
+            large_in_use++;
+            large_allocs++;
+        }
+        return obj;
+    }
+
+    c = &classes[(size - 1) / POOL_GRAIN];
+    if (c->free == NULL) {
+        object_size = ((size - 1) / POOL_GRAIN + 1) * POOL_GRAIN;
+        n = POOL_SLAB / object_size;
+        if (n < 4) n = 4;
+        slab = Malloc(n * object_size);
+        if (slab == NULL) return NULL;
+        for (i = n - 1; i >= 0; i--) {
+            obj = (free_object *)(slab + i * object_size);
+            obj->next = c->free;
+            c->free = obj;
+        }
+        c->slabs++;
+    }
+    obj = c->free;
+    c->free = obj->next;
+    c->allocs++;
+    if (++c->in_use > c->peak) c->peak = c->in_use;
+    return obj;
+}
+
+void pool_free(void *p, size_t size)
+{
+    size_class *c;
+    free_object *obj;
+
+    if (p == NULL) return;
+    if (size == 0) size = 1;
+    if (size > POOL_MAX) {
+        Free(p);
+        large_in_use--;
+        return;
+    }
+    c = &classes[(size - 1) / POOL_GRAIN];
+    obj = (free_object *)p;
+    obj->next = c->free;
+    c->free = obj;
+    c->in_use--;
+}
+
+char *arena_set(string_arena *a, char **slot, char *s)
+{
+    char *block;
+    int i, j, len, live, size, used, n;
+
+    for (i = 0; i < ARENA_SLOTS && a->slots[i] != slot; i++)
+        ;
+    if (i == ARENA_SLOTS) {
+        for (i = 0; i < ARENA_SLOTS && a->slots[i] != NULL; i++)
+            ;
+        if (i == ARENA_SLOTS) {
+            fprintf(stderr, "AHWM: arena_set: out of slots\n"); /* bug */
+            *slot = NULL;
+            return NULL;
+        }
+        a->slots[i] = slot;
+        *slot = NULL;
+    }
+    if (s == NULL) {
+        *slot = NULL;
+        return NULL;
+    }
+    len = strlen(s) + 1;
+
+    /* the common case: a title changes to one no longer than before */
+    if (*slot >= a->block && *slot < a->block + a->size
+        && strlen(*slot) + 1 >= len) {
+        memmove(*slot, s, len);
+        return *slot;
+    }
+    if (a->used + len <= a->size) {
+        *slot = a->block + a->used;
+        a->used += len;
+        memcpy(*slot, s, len);
+        return *slot;
+    }
+
+    /* full; copy the live strings and S into a new block twice as
+     * big as they need.  S may be in the old block. */
+    live = len;
+    for (j = 0; j < ARENA_SLOTS; j++) {
+        if (j != i && a->slots[j] != NULL && *a->slots[j] != NULL) {
+            live += strlen(*a->slots[j]) + 1;
+        }
+    }
+    for (size = ARENA_MIN; size < 2 * live; size *= 2)
+        ;
+    block = pool_alloc(size);
+    if (block == NULL) {
+        *slot = NULL;
+        return NULL;
+    }
+    used = 0;
+    for (j = 0; j < ARENA_SLOTS; j++) {
+        if (j != i && a->slots[j] != NULL && *a->slots[j] != NULL) {
+            n = strlen(*a->slots[j]) + 1;
+            memcpy(block + used, *a->slots[j], n);
+            *a->slots[j] = block + used;
+            used += n;
+        }
+    }
+    memcpy(block + used, s, len);
+    *slot = block + used;
+    used += len;
+
+    if (a->block != NULL) {
+        pool_free(a->block, a->size);
+        arena_bytes -= a->size;
+        arena_compactions++;
+    } else {
+        arena_blocks++;
+    }
+    arena_bytes += size;
+    a->block = block;
+    a->size = size;
+    a->used = used;
+    return *slot;
+}
+
+void arena_release(string_arena *a)
+{
+    int i;
+
+    for (i = 0; i < ARENA_SLOTS; i++) {
+        if (a->slots[i] != NULL) *a->slots[i] = NULL;
+    }
+    if (a->block != NULL) {
+        pool_free(a->block, a->size);
+        arena_blocks--;
+        arena_bytes -= a->size;
+    }
+    memset(a, 0, sizeof(string_arena));
+}
+
+void pool_report(report_fn out)
+{
+    int i;
+    size_class *c;
+
+    out("pool: size slabs in-use peak allocs\n");
+    for (i = 0; i < POOL_NCLASSES; i++) {
+        c = &classes[i];
+        if (c->slabs == 0) continue;
+        out("pool: %4d %5lu %6lu %6lu %8lu\n", (i + 1) * POOL_GRAIN,
+            c->slabs, c->in_use, c->peak, c->allocs);
+    }
+    out("pool: large objects %lu in use, %lu allocated\n",
+        large_in_use, large_allocs);
+    out("pool: string arenas %lu, %lu bytes, %lu compactions\n",
+        arena_blocks, arena_bytes, arena_compactions);
+}
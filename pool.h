@@ -0,0 +1,90 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "debug.h"
+
+/*
+ * Size-class pools for the small fixed-size objects we make and throw
+ * away all the time (clients, focus nodes, shading and animation
+ * records).  Objects are carved out of slabs which are never given
+ * back to malloc, so a long session that keeps opening and closing
+ * windows reuses the same memory instead of fragmenting the heap.
+ * Objects larger than POOL_MAX simply come from malloc.
+ * 
+ * The caller must pass pool_free() the size it gave pool_alloc().
+ */
+
+#define POOL_MAX 1024
+
+void *pool_alloc(size_t size);
+void pool_free(void *p, size_t size);
+
+/*
+ * A string arena holds all of one client's strings in one block, so
+ * they are freed together when the client goes away.  Each string
+ * lives in a slot (a char * somewhere that doesn't move, such as a
+ * member of client_t); arena_set() copies a string into the arena and
+ * points the slot at it, reusing the slot's old storage when the new
+ * string fits and otherwise compacting the block into a new one, so
+ * an arena never grows beyond about twice its live strings no matter
+ * how often a window changes its title.  A zeroed arena is empty.
+ */
+
+#define ARENA_SLOTS 4
+
+typedef struct _string_arena {
+    char *block;
+    int size;                   /* bytes in block */
+    int used;                   /* bytes handed out */
+    char **slots[ARENA_SLOTS];  /* the strings which are alive */
+} string_arena;
+
+/*
+ * Set *SLOT to a copy of S, which may be NULL.  Returns the copy, or
+ * NULL (leaving *SLOT as NULL) if out of memory.
+ */
+
+char *arena_set(string_arena *a, char **slot, char *s);
+
+/*
+ * Free the arena's block; the slots are set to NULL.
+ */
+
+void arena_release(string_arena *a);
+
+/*
+ * Write the statistics of the pools and arenas through OUT.
+ */
+
+void pool_report(report_fn out);
+
+#endif /* POOL_H */
@@ -0,0 +1,151 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "prefs.h"
+#include "prefs-core.h"
+#include "client.h"
+#include "workspace.h"
+#include "debug.h"
+
+/*
+ * Following three utility functions set the pointer argument and
+ * return True if the type is correct.
+ */
+
+void prefs_get_int(type *typ, int *val)
+{
+    *val = 0;
+    
+    if (typ->type_type != STRING && typ->type_type != BOOLEAN) {
+        *val = typ->type_value.intval;
+    }
+}
+
+void prefs_get_string(type *typ, char **val)
+{
+    *val = NULL;
+    if (typ->type_type == STRING) {
+        *val = typ->type_value.stringval;
+    }
+}
+
+void prefs_get_bool(type *typ, Bool *val)
+{
+    *val = False;
+    if (typ->type_type == BOOLEAN) {
+        *val = typ->type_value.intval;
+    }
+}
+
+/*
+ * Returns True if given context applies to given client.
+ */
+
+Bool prefs_context_applies(client_t *client, context *cntxt)
+{
+    Bool retval;
+    int orig_selector;
+    Bool type_bool;
+    char *type_string;
+    int type_int;
+    client_t *c;
+    
+    if (cntxt->context_selector & SEL_TRANSIENTFOR) {
+        c = client_find(client->transient_for);
+        if (c == NULL) {
+            retval = False;
+        } else {
+            orig_selector = cntxt->context_selector;
+            cntxt->context_selector &=
+                ~(SEL_NOT | SEL_TRANSIENTFOR | SEL_HASTRANSIENT);
+            retval = prefs_context_applies(c, cntxt);
+            cntxt->context_selector = orig_selector;
+        }
+    } else if (cntxt->context_selector & SEL_HASTRANSIENT) {
+        orig_selector = cntxt->context_selector;
+        cntxt->context_selector &=
+            ~(SEL_NOT | SEL_TRANSIENTFOR | SEL_HASTRANSIENT);
+        retval = False;
+        for (c = client->transients;
+             c != NULL && retval == False;
+             c = c->next_transient) {
+            retval = prefs_context_applies(c, cntxt);
+        }
+        cntxt->context_selector = orig_selector;
+    } else if (cntxt->context_selector & SEL_ISSHAPED) {
+        prefs_get_bool(cntxt->context_value, &type_bool);
+        retval = client->is_shaped == (type_bool == True ? 1 : 0);
+    } else if (cntxt->context_selector & SEL_INWORKSPACE) {
+        prefs_get_int(cntxt->context_value, &type_int);
+        if (client->workspace == 0) {
+            retval = workspace_current == (unsigned)type_int;
+        } else {
+            retval = client->workspace == (unsigned)type_int;
+        }
+    } else if (cntxt->context_selector & SEL_WINDOWNAME) {
+        prefs_get_string(cntxt->context_value, &type_string);
+        if (strcmp(type_string, "*") == 0) {
+            retval = True;
+        } else {
+            retval = !(strcmp(client->name, type_string));
+        }
+    } else if (cntxt->context_selector & SEL_WINDOWCLASS) {
+        prefs_get_string(cntxt->context_value, &type_string);
+        if (strcmp(type_string, "*") == 0) {
+            retval = True;
+        } else {
+            if (client->class == NULL) {
+                retval = False;
+            } else {
+                retval = !(strcmp(client->class, type_string));
+                if (retval) {
+                    debug(("\tPrefs: matched window class '%s'\n", client->class));
+                }
+            }
+        }
+    } else if (cntxt->context_selector & SEL_WINDOWINSTANCE) {
+        prefs_get_string(cntxt->context_value, &type_string);
+        if (strcmp(type_string, "*") == 0) {
+            retval = True;
+        } else {
+            if (client->instance == NULL) {
+                retval = False;
+            } else {
+                retval = !(strcmp(client->instance, type_string));
+            }
+        }
+    } else {
+        fprintf(stderr, "AHWM: context selector %d\n", cntxt->context_selector);
+        return False;
+    }
+    
+    if (cntxt->context_selector & SEL_NOT) return !retval;
+    else return retval;
+}
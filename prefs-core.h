@@ -0,0 +1,55 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Matching clients against the contexts of the configuration file
+ * (see prefs.c).  Nothing here talks to the X server, so matching can
+ * be run and timed without one.
+ */
+
+#ifndef PREFS_CORE_H
+#define PREFS_CORE_H
+
+#include "config.h"
+
+#include "prefs.h"
+
+/*
+ * Returns True if the context CNTXT applies to CLIENT.  Looks up
+ * transient parents with client_find().
+ */
+
+Bool prefs_context_applies(client_t *client, context *cntxt);
+
+/*
+ * These set the pointer argument to the value of TYP, or to zero if
+ * TYP is of another type.
+ */
+
+void prefs_get_int(type *typ, int *val);
+void prefs_get_string(type *typ, char **val);
+void prefs_get_bool(type *typ, Bool *val);
+
+#endif /* PREFS_CORE_H */
@@ -49,6 +49,7 @@
 
 #include "compat.h"
 #include "prefs.h"
+#include "prefs-core.h"
 #include "parser.h"
 #include "debug.h"
 #include "workspace.h"
@@ -61,6 +62,10 @@
 #include "paint.h"
 #include "stacking.h"
 #include "shade.h"
+#include "animation.h"
+#include "trace.h"
+#include "xstats.h"
+#include "latency.h"
 
 #include "default-ahwmrc.h"
 #include "default-message.h"
@@ -154,10 +159,6 @@ static int ndefinitions = 0;
 
 static void make_definition(definition *def);
 static void invocation_string_to_int(arglist *arg);
-static void get_int(type *typ, int *val);
-static void get_string(type *typ, char **val);
-static void get_bool(type *typ, Bool *val);
-static Bool context_applies(client_t *client, context *cntxt);
 static void option_apply(client_t *client, option *opt, prefs *p);
 static line *type_check(line *block);
 static Bool type_check_context(context *cntxt);
@@ -291,7 +292,7 @@ void prefs_init()
             case OPTION:
                 if (lp->line_value.option->option_name == NWORKSPACES) {
                     /* special case: option only applies globally */
-                    get_int(lp->line_value.option->option_value, &i);
+                    prefs_get_int(lp->line_value.option->option_value, &i);
                     if (i < 1) {
                         fprintf(stderr,
                                 "AHWM: NumberOfWorkspaces must be at least one\n");
@@ -300,8 +301,48 @@ void prefs_init()
                     }
                 } else if (lp->line_value.option->option_name == TITLEBARFONT) {
                     /* another global-only option */
-                    get_string(lp->line_value.option->option_value,
+                    prefs_get_string(lp->line_value.option->option_value,
                                &ahwm_fontname);
+                } else if (lp->line_value.option->option_name
+                           == ANIMATIONLENGTH) {
+                    /* also global-only */
+                    prefs_get_int(lp->line_value.option->option_value, &i);
+                    if (i < 0) {
+                        fprintf(stderr,
+                                "AHWM: AnimationLength may not be negative\n");
+                    } else {
+                        animation_length = i;
+                    }
+                } else if (lp->line_value.option->option_name
+                           == ANIMATIONFRAMERATE) {
+                    /* also global-only */
+                    prefs_get_int(lp->line_value.option->option_value, &i);
+                    if (i < 1) {
+                        fprintf(stderr,
+                                "AHWM: AnimationFrameRate must be at least one\n");
+                    } else {
+                        animation_frame_rate = i;
+                    }
+                } else if (lp->line_value.option->option_name
+                           == FOCUSSETTLETIME) {
+                    /* also global-only */
+                    prefs_get_int(lp->line_value.option->option_value, &i);
+                    if (i < 0) {
+                        fprintf(stderr,
+                                "AHWM: FocusSettleTime may not be negative\n");
+                    } else {
+                        focus_settle_time = i;
+                    }
+                } else if (lp->line_value.option->option_name
+                           == ROUNDTRIPBUDGET) {
+                    /* also global-only */
+                    prefs_get_int(lp->line_value.option->option_value, &i);
+                    if (i < 0) {
+                        fprintf(stderr,
+                                "AHWM: RoundTripBudget may not be negative\n");
+                    } else {
+                        xstats_budget = i;
+                    }
                 } else {
                     option_apply(NULL, lp->line_value.option, &defaults);
                 }
@@ -577,6 +618,22 @@ static Bool type_check_option(option *opt)
             retval = type_check_helper(opt->option_value, INTEGER,
                                        "WindowKillingPatience", "option");
             break;
+        case ANIMATIONLENGTH:
+            retval = type_check_helper(opt->option_value, INTEGER,
+                                       "AnimationLength", "option");
+            break;
+        case ANIMATIONFRAMERATE:
+            retval = type_check_helper(opt->option_value, INTEGER,
+                                       "AnimationFrameRate", "option");
+            break;
+        case FOCUSSETTLETIME:
+            retval = type_check_helper(opt->option_value, INTEGER,
+                                       "FocusSettleTime", "option");
+            break;
+        case ROUNDTRIPBUDGET:
+            retval = type_check_helper(opt->option_value, INTEGER,
+                                       "RoundTripBudget", "option");
+            break;
         default:
             fprintf(stderr, "AHWM: unknown option type found...\n");
             retval = False;
@@ -738,7 +795,7 @@ static void prefs_apply_internal(client_t *client, line *block, prefs *p)
     for (lp = block; lp != NULL; lp = lp->line_next) {
         switch (lp->line_type) {
             case CONTEXT:
-                if (context_applies(client, lp->line_value.context)) {
+                if (prefs_context_applies(client, lp->line_value.context)) {
                     prefs_apply_internal(client,
                                          lp->line_value.context->context_lines,
                                          p);
@@ -766,122 +823,6 @@ static void prefs_apply_internal(client_t *client, line *block, prefs *p)
     }
 }
 
-/*
- * Following three utility functions set the pointer argument and
- * return True if the type is correct.
- */
-
-static void get_int(type *typ, int *val)
-{
-    *val = 0;
-    
-    if (typ->type_type != STRING && typ->type_type != BOOLEAN) {
-        *val = typ->type_value.intval;
-    }
-}
-
-static void get_string(type *typ, char **val)
-{
-    *val = NULL;
-    if (typ->type_type == STRING) {
-        *val = typ->type_value.stringval;
-    }
-}
-
-static void get_bool(type *typ, Bool *val)
-{
-    *val = False;
-    if (typ->type_type == BOOLEAN) {
-        *val = typ->type_value.intval;
-    }
-}
-
-/*
- * Returns True if given context applies to given client.
- */
-
-static Bool context_applies(client_t *client, context *cntxt)
-{
-    Bool retval;
-    int orig_selector;
-    Bool type_bool;
-    char *type_string;
-    int type_int;
-    client_t *c;
-    
-    if (cntxt->context_selector & SEL_TRANSIENTFOR) {
-        c = client_find(client->transient_for);
-        if (c == NULL) {
-            retval = False;
-        } else {
-            orig_selector = cntxt->context_selector;
-            cntxt->context_selector &=
-                ~(SEL_NOT | SEL_TRANSIENTFOR | SEL_HASTRANSIENT);
-            retval = context_applies(c, cntxt);
-            cntxt->context_selector = orig_selector;
-        }
-    } else if (cntxt->context_selector & SEL_HASTRANSIENT) {
-        orig_selector = cntxt->context_selector;
-        cntxt->context_selector &=
-            ~(SEL_NOT | SEL_TRANSIENTFOR | SEL_HASTRANSIENT);
-        retval = False;
-        for (c = client->transients;
-             c != NULL && retval == False;
-             c = c->next_transient) {
-            retval = context_applies(c, cntxt);
-        }
-        cntxt->context_selector = orig_selector;
-    } else if (cntxt->context_selector & SEL_ISSHAPED) {
-        get_bool(cntxt->context_value, &type_bool);
-        retval = client->is_shaped == (type_bool == True ? 1 : 0);
-    } else if (cntxt->context_selector & SEL_INWORKSPACE) {
-        get_int(cntxt->context_value, &type_int);
-        if (client->workspace == 0) {
-            retval = workspace_current == (unsigned)type_int;
-        } else {
-            retval = client->workspace == (unsigned)type_int;
-        }
-    } else if (cntxt->context_selector & SEL_WINDOWNAME) {
-        get_string(cntxt->context_value, &type_string);
-        if (strcmp(type_string, "*") == 0) {
-            retval = True;
-        } else {
-            retval = !(strcmp(client->name, type_string));
-        }
-    } else if (cntxt->context_selector & SEL_WINDOWCLASS) {
-        get_string(cntxt->context_value, &type_string);
-        if (strcmp(type_string, "*") == 0) {
-            retval = True;
-        } else {
-            if (client->class == NULL) {
-                retval = False;
-            } else {
-                retval = !(strcmp(client->class, type_string));
-                if (retval) {
-                    debug(("\tPrefs: matched window class '%s'\n", client->class));
-                }
-            }
-        }
-    } else if (cntxt->context_selector & SEL_WINDOWINSTANCE) {
-        get_string(cntxt->context_value, &type_string);
-        if (strcmp(type_string, "*") == 0) {
-            retval = True;
-        } else {
-            if (client->instance == NULL) {
-                retval = False;
-            } else {
-                retval = !(strcmp(client->instance, type_string));
-            }
-        }
-    } else {
-        fprintf(stderr, "AHWM: context selector %d\n", cntxt->context_selector);
-        return False;
-    }
-    
-    if (cntxt->context_selector & SEL_NOT) return !retval;
-    else return retval;
-}
-
 /*
  * Applies given option to given client.
  */
@@ -890,83 +831,84 @@ static void option_apply(client_t *client, option *opt, prefs *p)
     switch (opt->option_name) {
         /* ADDOPT 8: set option if found within a context */
         case DISPLAYTITLEBAR:
-            get_bool(opt->option_value, &p->titlebar);
+            prefs_get_bool(opt->option_value, &p->titlebar);
             p->titlebar_set = opt->option_setting;
             break;
         case OMNIPRESENT:
-            get_bool(opt->option_value, &p->omnipresent);
+            prefs_get_bool(opt->option_value, &p->omnipresent);
             p->omnipresent_set = opt->option_setting;
             break;
         case DEFAULTWORKSPACE:
-            get_int(opt->option_value, &p->workspace);
+            prefs_get_int(opt->option_value, &p->workspace);
             p->workspace_set = opt->option_setting;
             break;
         case FOCUSPOLICY:
-            get_int(opt->option_value, &p->focus_policy);
+            prefs_get_int(opt->option_value, &p->focus_policy);
             p->focus_policy_set = opt->option_setting;
             break;
         case CYCLEBEHAVIOUR:
-            get_int(opt->option_value, &p->cycle_behaviour);
+            prefs_get_int(opt->option_value, &p->cycle_behaviour);
             p->cycle_behaviour_set = opt->option_setting;
             break;
         case ALWAYSONTOP:
-            get_bool(opt->option_value, &p->always_on_top);
+            prefs_get_bool(opt->option_value, &p->always_on_top);
             p->always_on_top_set = opt->option_setting;
             break;
         case ALWAYSONBOTTOM:
-            get_bool(opt->option_value, &p->always_on_bottom);
+            prefs_get_bool(opt->option_value, &p->always_on_bottom);
             p->always_on_bottom_set = opt->option_setting;
             break;
         case PASSFOCUSCLICK:
-            get_bool(opt->option_value, &p->pass_focus_click);
+            prefs_get_bool(opt->option_value, &p->pass_focus_click);
             p->pass_focus_click_set = opt->option_setting;
             break;
         case COLORTITLEBAR:
-            get_string(opt->option_value, &p->titlebar_color);
+            prefs_get_string(opt->option_value, &p->titlebar_color);
             p->titlebar_color_set = opt->option_setting;
             break;
         case COLORTITLEBARFOCUSED:
-            get_string(opt->option_value, &p->titlebar_focused_color);
+            prefs_get_string(opt->option_value, &p->titlebar_focused_color);
             p->titlebar_focused_color_set = opt->option_setting;
             break;
         case COLORTEXT:
-            get_string(opt->option_value, &p->titlebar_text_color);
+            prefs_get_string(opt->option_value, &p->titlebar_text_color);
             p->titlebar_text_color_set = opt->option_setting;
             break;
         case COLORTEXTFOCUSED:
-            get_string(opt->option_value, &p->titlebar_text_focused_color);
+            prefs_get_string(opt->option_value,
+                             &p->titlebar_text_focused_color);
             p->titlebar_text_focused_color_set = opt->option_setting;
             break;
         case DONTBINDMOUSE:
-            get_bool(opt->option_value, &p->dont_bind_mouse);
+            prefs_get_bool(opt->option_value, &p->dont_bind_mouse);
             p->dont_bind_mouse_set = opt->option_setting;
             break;
         case DONTBINDKEYS:
-            get_bool(opt->option_value, &p->dont_bind_keys);
+            prefs_get_bool(opt->option_value, &p->dont_bind_keys);
             p->dont_bind_mouse_set = opt->option_setting;
             break;
         case STICKY:
-            get_bool(opt->option_value, &p->sticky);
+            prefs_get_bool(opt->option_value, &p->sticky);
             p->sticky_set = opt->option_setting;
             break;
         case TITLEPOSITION:
-            get_int(opt->option_value, &p->title_position);
+            prefs_get_int(opt->option_value, &p->title_position);
             p->title_position_set = opt->option_setting;
             break;
         case KEEPTRANSIENTSONTOP:
-            get_bool(opt->option_value, &p->keep_transients_on_top);
+            prefs_get_bool(opt->option_value, &p->keep_transients_on_top);
             p->keep_transients_on_top_set = opt->option_setting;
             break;
         case RAISEDELAY:
-            get_int(opt->option_value, &p->raise_delay);
+            prefs_get_int(opt->option_value, &p->raise_delay);
             p->raise_delay_set = opt->option_setting;
             break;
         case USENETWMPID:
-            get_bool(opt->option_value, &p->use_net_wm_pid);
+            prefs_get_bool(opt->option_value, &p->use_net_wm_pid);
             p->use_net_wm_pid_set = opt->option_setting;
             break;
         case KILLINGPATIENCE:
-            get_int(opt->option_value, &p->patience);
+            prefs_get_int(opt->option_value, &p->patience);
             p->patience_set = opt->option_setting;
             break;
         default:
@@ -1012,6 +954,7 @@ void prefs_apply(client_t *client)
 {
     prefs p;
 
+    TRACE1(prefs_apply, client->window);
     memcpy(&p, &defaults, sizeof(prefs));
 
     prefs_apply_internal(client, contexts, &p);
@@ -1335,12 +1278,42 @@ static void invoke(XEvent *e, arglist *args)
         for (fl = definitions[i]->funclist; fl != NULL; fl = fl->next) {
             fn = fn_table[fl->func->function_type];
             if (fn != NULL) {
-                (*fn)(e, fl->func->function_args);
+                latency_call(fn, e, fl->func->function_args);
             }
         }
     }
 }
 
+Bool prefs_invoke(char *name, XEvent *e)
+{
+    funclist *fl;
+    key_fn fn;
+    int i;
+
+    for (i = 0; i < ndefinitions; i++) {
+        if (strcmp(definitions[i]->identifier, name) == 0) {
+            for (fl = definitions[i]->funclist; fl != NULL; fl = fl->next) {
+                fn = fn_table[fl->func->function_type];
+                if (fn != NULL) {
+                    latency_call(fn, e, fl->func->function_args);
+                }
+            }
+            return True;
+        }
+    }
+    return False;
+}
+
+char *prefs_function_name(key_fn fn)
+{
+    int i;
+
+    for (i = 0; i < sizeof(fn_table) / sizeof(fn_table[0]); i++) {
+        if (fn_table[i] == fn && fn != NULL) return fn_names[i];
+    }
+    return NULL;
+}
+
 static void focus(XEvent *e, arglist *args)
 {
     client_t *client;
@@ -134,7 +134,11 @@ struct _option {
            KEEPTRANSIENTSONTOP,
            RAISEDELAY,
            USENETWMPID,
-           KILLINGPATIENCE
+           KILLINGPATIENCE,
+           ANIMATIONLENGTH,
+           ANIMATIONFRAMERATE,
+           FOCUSSETTLETIME,
+           ROUNDTRIPBUDGET
     } option_name;
     option_setting option_setting;
     type *option_value;
@@ -222,7 +226,7 @@ extern line *preferences;
 void prefs_init();
 
 /*
- * There are only two functions to interface to this module.
+ * There are only three functions to interface to this module.
  * 
  * This function should be called:
  * 1. when the client is created
@@ -232,4 +236,19 @@ void prefs_init();
 
 void prefs_apply(client_t *client);
 
+/*
+ * Run the functions of the Define()d composition called NAME as if
+ * invoked by a binding with event E.  Returns False if there is no
+ * such definition.  Used by ipc.c.
+ */
+
+Bool prefs_invoke(char *name, XEvent *e);
+
+/*
+ * The name a bindable function has in the configuration file, or
+ * NULL if FN isn't one.  Used by latency.c.
+ */
+
+char *prefs_function_name(key_fn fn);
+
 #endif /* PREFS_H */
@@ -0,0 +1,317 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ahwm.h"
+#include "record.h"
+#include "timer.h"
+#include "malloc.h"
+#include "compat.h"
+
+#define RECORD_ATOMS 1024       /* atoms whose names we've written */
+#define RECORD_MAX_PROPERTY 16384 /* longs of a property we record */
+
+static FILE *out = NULL;
+static Atom atoms_written[RECORD_ATOMS];
+
+static void write_record(int kind, void *payload, int len,
+                         void *extra, int extra_len);
+static void record_atom(Atom atom);
+static void record_property(Window w, Atom property);
+static void record_window(Window w, XWindowAttributes *xwa, Bool mapped);
+
+void record_init()
+{
+    record_file_header h;
+    XWindowAttributes xwa;
+    Window *wins, junk;
+    unsigned int i, n;
+    char *file;
+
+    file = getenv("AHWM_RECORD");
+    if (file == NULL || *file == '\0') return;
+    out = fopen(file, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "AHWM: Could not open recording file '%s': %s\n",
+                file, strerror(errno));
+        return;
+    }
+    fcntl(fileno(out), F_SETFD, FD_CLOEXEC);
+    putenv("AHWM_RECORD=");
+
+    h.magic = RECORD_MAGIC;
+    h.version = RECORD_VERSION;
+    h.width = scr_width;
+    h.height = scr_height;
+    h.root = root_window;
+    fwrite(&h, sizeof(h), 1, out);
+
+    if (XQueryTree(dpy, root_window, &junk, &junk, &wins, &n) == 0)
+        return;
+    for (i = 0; i < n; i++) {
+        if (XGetWindowAttributes(dpy, wins[i], &xwa) != 0
+            && !xwa.override_redirect && xwa.map_state != IsUnmapped) {
+            record_window(wins[i], &xwa, True);
+        }
+    }
+    if (wins != NULL) XFree(wins);
+}
+
+void record_flush()
+{
+    if (out != NULL) fflush(out);
+}
+
+void record_event(XEvent *e)
+{
+    recorded_event re;
+    XWindowAttributes xwa;
+    int i;
+
+    if (out == NULL) return;
+    memset(&re, 0, sizeof(re));
+    re.type = e->type;
+    re.send_event = e->xany.send_event;
+    re.window = e->xany.window;
+
+    switch (e->type) {
+        case KeyPress:
+        case KeyRelease:
+            re.time = e->xkey.time;
+            re.x = e->xkey.x;
+            re.y = e->xkey.y;
+            re.x_root = e->xkey.x_root;
+            re.y_root = e->xkey.y_root;
+            re.state = e->xkey.state;
+            re.detail = e->xkey.keycode;
+            break;
+        case ButtonPress:
+        case ButtonRelease:
+            re.time = e->xbutton.time;
+            re.x = e->xbutton.x;
+            re.y = e->xbutton.y;
+            re.x_root = e->xbutton.x_root;
+            re.y_root = e->xbutton.y_root;
+            re.state = e->xbutton.state;
+            re.detail = e->xbutton.button;
+            break;
+        case MotionNotify:
+            re.time = e->xmotion.time;
+            re.x = e->xmotion.x;
+            re.y = e->xmotion.y;
+            re.x_root = e->xmotion.x_root;
+            re.y_root = e->xmotion.y_root;
+            re.state = e->xmotion.state;
+            break;
+        case EnterNotify:
+        case LeaveNotify:
+            re.time = e->xcrossing.time;
+            re.x = e->xcrossing.x;
+            re.y = e->xcrossing.y;
+            re.x_root = e->xcrossing.x_root;
+            re.y_root = e->xcrossing.y_root;
+            re.state = e->xcrossing.state;
+            re.detail = e->xcrossing.mode;
+            break;
+        case MapRequest:
+            re.window = e->xmaprequest.window;
+            /* the replay needs a stand-in before it can map it */
+            if (XGetWindowAttributes(dpy, re.window, &xwa) != 0)
+                record_window(re.window, &xwa, False);
+            break;
+        case ConfigureRequest:
+            re.window = e->xconfigurerequest.window;
+            re.x = e->xconfigurerequest.x;
+            re.y = e->xconfigurerequest.y;
+            re.width = e->xconfigurerequest.width;
+            re.height = e->xconfigurerequest.height;
+            re.border = e->xconfigurerequest.border_width;
+            re.detail = e->xconfigurerequest.value_mask;
+            re.above = e->xconfigurerequest.above;
+            re.stack_mode = e->xconfigurerequest.detail;
+            break;
+        case CirculateRequest:
+            re.window = e->xcirculaterequest.window;
+            re.detail = e->xcirculaterequest.place;
+            break;
+        case MapNotify:
+            re.window = e->xmap.window;
+            break;
+        case UnmapNotify:
+            re.window = e->xunmap.window;
+            break;
+        case DestroyNotify:
+            re.window = e->xdestroywindow.window;
+            break;
+        case ReparentNotify:
+            re.window = e->xreparent.window;
+            break;
+        case ConfigureNotify:
+            re.window = e->xconfigure.window;
+            re.x = e->xconfigure.x;
+            re.y = e->xconfigure.y;
+            re.width = e->xconfigure.width;
+            re.height = e->xconfigure.height;
+            re.border = e->xconfigure.border_width;
+            break;
+        case PropertyNotify:
+            re.time = e->xproperty.time;
+            re.state = e->xproperty.state;
+            re.detail = e->xproperty.atom;
+            /* root properties are mostly our own doing */
+            if (re.window != root_window)
+                record_property(re.window, e->xproperty.atom);
+            else
+                record_atom(e->xproperty.atom);
+            break;
+        case ClientMessage:
+            re.detail = e->xclient.message_type;
+            re.format = e->xclient.format;
+            for (i = 0; i < 5; i++)
+                re.data[i] = e->xclient.data.l[i];
+            record_atom(e->xclient.message_type);
+            break;
+    }
+    write_record(RECORD_EVENT, &re, sizeof(re), NULL, 0);
+}
+
+static void write_record(int kind, void *payload, int len,
+                         void *extra, int extra_len)
+{
+    static char zeros[4] = { 0, 0, 0, 0 };
+    record_header h;
+    struct timeval tv;
+    int pad;
+
+    timer_now(&tv);
+    pad = (4 - (len + extra_len) % 4) % 4;
+    h.kind = kind;
+    h.length = len + extra_len + pad;
+    h.sec = tv.tv_sec;
+    h.usec = tv.tv_usec;
+    fwrite(&h, sizeof(h), 1, out);
+    fwrite(payload, len, 1, out);
+    if (extra_len > 0) fwrite(extra, extra_len, 1, out);
+    if (pad > 0) fwrite(zeros, pad, 1, out);
+}
+
+static void record_atom(Atom atom)
+{
+    CARD32 id;
+    char *name;
+    int i, n;
+
+    if (atom == None) return;
+    i = atom % RECORD_ATOMS;
+    for (n = 0; n < RECORD_ATOMS; n++) {
+        if (atoms_written[i] == atom) return;
+        if (atoms_written[i] == None) break;
+        i = (i + 1) % RECORD_ATOMS;
+    }
+    /* if the table is full we just write it again */
+    if (n < RECORD_ATOMS) atoms_written[i] = atom;
+    name = XGetAtomName(dpy, atom);
+    if (name == NULL) return;
+    id = atom;
+    write_record(RECORD_ATOM, &id, sizeof(id), name, strlen(name) + 1);
+    XFree(name);
+}
+
+static void record_property(Window w, Atom property)
+{
+    recorded_property rp;
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after, i;
+    unsigned char *data;
+    CARD32 *longs;
+    int len;
+
+    record_atom(property);
+    data = NULL;
+    if (XGetWindowProperty(dpy, w, property, 0, RECORD_MAX_PROPERTY,
+                           False, AnyPropertyType, &type, &format,
+                           &nitems, &bytes_after, &data) != Success) {
+        return;
+    }
+    rp.window = w;
+    rp.atom = property;
+    rp.type = type;
+    rp.format = format;
+    rp.nitems = nitems;
+    if (type == None) {
+        rp.format = 0;
+        rp.nitems = 0;
+        write_record(RECORD_PROPERTY, &rp, sizeof(rp), NULL, 0);
+    } else if (format == 32) {
+        /* Xlib hands us longs, which may be longer than 32 bits */
+        record_atom(type);
+        longs = Malloc(nitems * sizeof(CARD32) + 1);
+        if (longs != NULL) {
+            for (i = 0; i < nitems; i++)
+                longs[i] = ((long *)data)[i];
+            write_record(RECORD_PROPERTY, &rp, sizeof(rp),
+                         longs, nitems * sizeof(CARD32));
+            Free(longs);
+        }
+    } else {
+        record_atom(type);
+        len = nitems * (format / 8);
+        write_record(RECORD_PROPERTY, &rp, sizeof(rp), data, len);
+    }
+    if (data != NULL) XFree(data);
+}
+
+static void record_window(Window w, XWindowAttributes *xwa, Bool mapped)
+{
+    recorded_window rw;
+    Atom *properties;
+    int i, n;
+
+    rw.window = w;
+    rw.x = xwa->x;
+    rw.y = xwa->y;
+    rw.width = xwa->width;
+    rw.height = xwa->height;
+    rw.border = xwa->border_width;
+    rw.mapped = mapped;
+    write_record(RECORD_WINDOW, &rw, sizeof(rw), NULL, 0);
+
+    properties = XListProperties(dpy, w, &n);
+    if (properties == NULL) return;
+    for (i = 0; i < n; i++)
+        record_property(w, properties[i]);
+    XFree(properties);
+}
@@ -0,0 +1,127 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xmd.h>
+
+/*
+ * Session recording, so that a slow session can be replayed later as
+ * a benchmark by ahwm-replay.  If AHWM_RECORD names a file when AHWM
+ * starts, every event event_get() returns is appended to it, along
+ * with what a replay needs to stand in for the clients: the geometry
+ * and properties of every window which is mapped at start-up or asks
+ * to be mapped later, and the new value of every property which
+ * changes on a client window.  Recording costs a few round trips per
+ * window and per property change, so it is off unless asked for.
+ * 
+ * The file is a record_file_header followed by records, each a
+ * record_header and 'length' bytes of payload (always a multiple of
+ * four).  Everything is in native byte order.  Atoms are numbered as
+ * they were on the recording server; a RECORD_ATOM record gives the
+ * name of each one before it is first used.  Atoms in the data of
+ * client messages and of properties are not translated.
+ */
+
+#define RECORD_MAGIC   0x52574841 /* "AHWR" on little-endian machines */
+#define RECORD_VERSION 1
+
+/* record kinds */
+#define RECORD_EVENT    1       /* recorded_event */
+#define RECORD_WINDOW   2       /* recorded_window */
+#define RECORD_PROPERTY 3       /* recorded_property, then the data */
+#define RECORD_ATOM     4       /* CARD32 atom, then its name */
+
+typedef struct _record_file_header {
+    CARD32 magic;
+    CARD32 version;
+    CARD32 width, height;       /* of the screen */
+    CARD32 root;                /* the root window's id */
+} record_file_header;
+
+typedef struct _record_header {
+    CARD32 kind;
+    CARD32 length;              /* of the payload */
+    CARD32 sec, usec;           /* monotonic time it was recorded */
+} record_header;
+
+/* the fields of an XEvent a replay can use */
+typedef struct _recorded_event {
+    CARD32 type;
+    CARD32 send_event;
+    CARD32 window;              /* the window the event is about */
+    CARD32 time;                /* server time, or zero */
+    INT32 x, y;                 /* pointer position or geometry */
+    INT32 x_root, y_root;
+    CARD32 width, height, border;
+    CARD32 state;               /* modifiers, or PropertyNotify state */
+    CARD32 detail;              /* keycode, button, value_mask, atom or
+                                 * message type */
+    CARD32 above, stack_mode;   /* ConfigureRequest */
+    CARD32 format;              /* ClientMessage */
+    CARD32 data[5];
+} recorded_event;
+
+typedef struct _recorded_window {
+    CARD32 window;
+    INT32 x, y;
+    CARD32 width, height, border;
+    CARD32 mapped;              /* mapped when recording started */
+} recorded_window;
+
+typedef struct _recorded_property {
+    CARD32 window;
+    CARD32 atom;
+    CARD32 type;                /* None if the property was deleted */
+    CARD32 format;              /* 8, 16 or 32 */
+    CARD32 nitems;              /* format 32 items are CARD32s */
+} recorded_property;
+
+/*
+ * Open AHWM_RECORD, if set, and record the windows which are already
+ * mapped.  Call just before the windows are scanned.  AHWM_RECORD is
+ * then cleared, so neither the programs we launch nor a restarted
+ * AHWM overwrite the recording.
+ */
+
+void record_init();
+
+/*
+ * Record an event just taken off the queue.
+ */
+
+void record_event(XEvent *e);
+
+/*
+ * Write out buffered records.  Called when the event loop goes idle.
+ */
+
+void record_flush();
+
+#endif /* RECORD_H */
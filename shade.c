@@ -26,6 +26,7 @@
 #include "shade.h"
 #include "animation.h"
 #include "client.h"
+#include "pool.h"
 
 #include <stdlib.h>
 #include <errno.h>
@@ -38,8 +39,6 @@
  * shaded clients shouldn't get keyboard input
  *   - either focus.c knows about client->shaded or ...
  * test on really slow machines
- * option to turn off animation
- * option to change animation interval
  * EWMH probably needs to know about this
  */
 
@@ -59,8 +58,6 @@ static void shade_callback(float m, void *v)
                   client->height - (client->height - TITLE_HEIGHT) * m);
     XMoveWindow(dpy, client->window, 0,
                 TITLE_HEIGHT - (client->height - TITLE_HEIGHT) * m);
-    if (client->titlebar != None)
-        XRaiseWindow(dpy, client->titlebar);
 }
 
 static void shade_finalize(void *v)
@@ -90,7 +87,7 @@ static void shade_finalize(void *v)
             if (shades == shade) {
                 shades = shade->next;
             }
-            free(shade);
+            pool_free(shade, sizeof(shade_t));
             return;
         }
         prev = shade;
@@ -106,6 +103,11 @@ void shade(XEvent *e, arglist *ignored)
     if (client == NULL) return;
 
     client->shaded = client->shaded ? 0 : 1;
+
+    /* the client window slides underneath the titlebar; the
+     * titlebar only needs to be raised once, not every frame */
+    if (client->titlebar != None)
+        XRaiseWindow(dpy, client->titlebar);
     
     for (shade = shades; shade != NULL; shade = shade->next) {
         if (shade->client == client) {
@@ -115,9 +117,9 @@ void shade(XEvent *e, arglist *ignored)
         }
     }
 
-    shade = malloc(sizeof(shade_t));
+    shade = pool_alloc(sizeof(shade_t));
     if (!shade) {
-        perror("AHWM: Cannot shade window: malloc");
+        fprintf(stderr, "AHWM: Cannot shade window: out of memory\n");
         return;
     }
     shade->anim = animate(shade_callback, shade_finalize, (void *)client);
@@ -0,0 +1,307 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(HAVE_SHM_OPEN) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#define USE_SNAPSHOT
+#endif
+
+#include <X11/Xlib.h>
+
+#include "snapshot.h"
+#include "ahwm.h"
+#include "client.h"
+#include "focus.h"
+#include "workspace.h"
+#include "stacking.h"
+#include "malloc.h"
+#include "debug.h"
+#include "compat.h"
+
+#ifdef USE_SNAPSHOT
+
+/* keep the compiler and the processor from moving stores across */
+#ifdef __GNUC__
+#define barrier() __sync_synchronize()
+#else
+#define barrier()
+#endif
+
+static snapshot_header *shared = NULL;
+static char shm_name[64];
+static pid_t shm_pid;
+static char env_buf[sizeof("AHWM_SNAPSHOT=") + sizeof(shm_name)];
+
+/*
+ * We build the snapshot here first and only touch the shared copy if
+ * it differs.  That's cheaper than finding every place that changes
+ * a name or a geometry, and means readers don't spin for nothing.
+ */
+
+static char *scratch = NULL;
+static int scratch_size = 0;
+
+static void snapshot_cleanup();
+static int build(int size);
+static Bool add_focus(client_t *client, void *v);
+
+typedef struct _focus_fill {
+    CARD32 *focus;
+    int nfocus, max;
+} focus_fill;
+
+void snapshot_init()
+{
+    struct stat st;
+    char *s;
+    int fd;
+
+    snprintf(shm_name, sizeof(shm_name), "/ahwm-%d-%s",
+             (int)getuid(), DisplayString(dpy));
+    for (s = shm_name + 1; *s != '\0'; s++) {
+        if (*s == '/') *s = '_';
+    }
+    fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    /* The name is easy to guess and /dev/shm is writable by anyone,
+     * so someone else may have made it first to read our window
+     * titles or feed readers lies.  Only reuse a segment which is
+     * ours and private (a predecessor's, after a restart). */
+    if (fd >= 0 && (fstat(fd, &st) < 0 || st.st_uid != getuid()
+                    || (st.st_mode & 077) != 0)) {
+        fprintf(stderr, "AHWM: %s is not ours or not private, "
+                "replacing it\n", shm_name);
+        close(fd);
+        shm_unlink(shm_name);
+        fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "AHWM: shm_open %s: %s\n", shm_name, strerror(errno));
+        return;
+    }
+    if (ftruncate(fd, SNAPSHOT_SIZE) < 0) {
+        perror("AHWM: snapshot: ftruncate");
+        close(fd);
+        return;
+    }
+    shared = mmap(NULL, SNAPSHOT_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+    close(fd);
+    if (shared == MAP_FAILED) {
+        perror("AHWM: snapshot: mmap");
+        shared = NULL;
+        return;
+    }
+    shm_pid = getpid();
+#ifdef HAVE_ATEXIT
+    atexit(snapshot_cleanup);
+#endif
+
+    /* a restarted AHWM may find its predecessor's segment; leave
+     * 'seq' alone so readers notice the new contents */
+    shared->seq |= 1;
+    barrier();
+    shared->magic = SNAPSHOT_MAGIC;
+    shared->version = SNAPSHOT_VERSION;
+    shared->size = sizeof(snapshot_header);
+    shared->nclients = shared->nfocus = 0;
+    barrier();
+    shared->seq++;
+
+    snprintf(env_buf, sizeof(env_buf), "AHWM_SNAPSHOT=%s", shm_name);
+    putenv(env_buf);
+}
+
+static void snapshot_cleanup()
+{
+    if (getpid() == shm_pid) {
+        shm_unlink(shm_name);
+    }
+}
+
+void snapshot_commit()
+{
+    int size;
+    CARD32 seq;
+
+    if (shared == NULL) return;
+
+    /* the first try is almost always big enough */
+    size = build(scratch_size);
+    if (size > scratch_size) {
+        size = build(size);
+    }
+    if (size < 0 || size > scratch_size) return;
+
+    seq = shared->seq;
+    ((snapshot_header *)scratch)->seq = seq;
+    if (size == shared->size && memcmp(scratch, shared, size) == 0) {
+        return;
+    }
+
+    shared->seq = seq + 1;
+    barrier();
+    memcpy((char *)shared + sizeof(CARD32) * 3,
+           scratch + sizeof(CARD32) * 3,
+           size - sizeof(CARD32) * 3);
+    barrier();
+    shared->seq = seq + 2;
+}
+
+/*
+ * Write the snapshot into 'scratch', growing it to SIZE first if
+ * needed.  Returns the size of the snapshot, which is larger than
+ * scratch_size if it didn't fit, or -1 if out of memory.
+ */
+
+static int build(int size)
+{
+    snapshot_header *h;
+    snapshot_client *sc;
+    client_t *client;
+    focus_fill ff;
+    int nclients, names, name_len, i;
+    char *tmp;
+
+    if (size > SNAPSHOT_SIZE) size = SNAPSHOT_SIZE;
+    if (size < 4096) size = 4096;
+    if (size > scratch_size) {
+        tmp = Realloc(scratch, size);
+        if (tmp == NULL) {
+            perror("AHWM: snapshot: realloc");
+            return -1;
+        }
+        scratch = tmp;
+        scratch_size = size;
+    }
+
+    nclients = 0;
+    for (client = stacking_top(); client != NULL;
+         client = stacking_prev(client)) {
+        nclients++;
+    }
+
+    h = (snapshot_header *)scratch;
+    memset(h, 0, sizeof(snapshot_header));
+    h->magic = SNAPSHOT_MAGIC;
+    h->version = SNAPSHOT_VERSION;
+    h->workspace = workspace_current;
+    h->nworkspaces = nworkspaces;
+    h->focused = focus_current != NULL ? focus_current->window : None;
+
+    /* clients, then focus indices, then names */
+    sc = (snapshot_client *)(scratch + sizeof(snapshot_header));
+    names = sizeof(snapshot_header)
+        + nclients * (sizeof(snapshot_client) + sizeof(CARD32));
+    if (names > SNAPSHOT_SIZE) {
+        nclients = (SNAPSHOT_SIZE - sizeof(snapshot_header))
+            / (sizeof(snapshot_client) + sizeof(CARD32));
+        names = sizeof(snapshot_header)
+            + nclients * (sizeof(snapshot_client) + sizeof(CARD32));
+        h->flags |= SNAPSHOT_TRUNCATED;
+    }
+
+    i = 0;
+    for (client = stacking_top(); client != NULL && i < nclients;
+         client = stacking_prev(client)) {
+        
+        name_len = strlen(client->name) + 1;
+        if (names + name_len > SNAPSHOT_SIZE) {
+            h->flags |= SNAPSHOT_TRUNCATED;
+            break;
+        }
+        if (names + name_len <= scratch_size) {
+            sc[i].window = client->window;
+            sc[i].x = client->x;
+            sc[i].y = client->y;
+            sc[i].width = client->width;
+            sc[i].height = client->height;
+            sc[i].workspace = client->workspace;
+            sc[i].flags = 0;
+            if (client == focus_current)
+                sc[i].flags |= SNAPSHOT_FOCUSED;
+            if (client->state == IconicState)
+                sc[i].flags |= SNAPSHOT_ICONIC;
+            if (client->omnipresent)
+                sc[i].flags |= SNAPSHOT_OMNIPRESENT;
+            if (client->unresponsive)
+                sc[i].flags |= SNAPSHOT_UNRESPONSIVE;
+            sc[i].name = names;
+            memcpy(scratch + names, client->name, name_len);
+        }
+        names += name_len;
+        i++;
+    }
+    if (names > scratch_size) {
+        return names;           /* caller grows us and tries again */
+    }
+    h->nclients = i;
+
+    /* we wrote the clients out from the top of the stacking order,
+     * so a client's index follows from its place in that order */
+    ff.focus = (CARD32 *)(sc + i);
+    ff.nfocus = 0;
+    ff.max = i;
+    focus_forall(add_focus, &ff);
+    h->nfocus = ff.nfocus;
+
+    /* the names were placed after room for 'nclients' focus entries;
+     * a truncated snapshot can leave a gap, which is harmless */
+    h->size = names;
+    return names;
+}
+
+static Bool add_focus(client_t *client, void *v)
+{
+    focus_fill *ff = (focus_fill *)v;
+    int i;
+
+    i = stacking_depth(client);
+    if (i >= 0 && i < ff->max && ff->nfocus < ff->max) {
+        ff->focus[ff->nfocus++] = i;
+    }
+    return True;
+}
+
+#else /* !USE_SNAPSHOT */
+
+void snapshot_init()
+{
+}
+
+void snapshot_commit()
+{
+}
+
+#endif /* USE_SNAPSHOT */
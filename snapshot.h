@@ -0,0 +1,102 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "config.h"
+
+#include <X11/Xmd.h>
+
+/*
+ * A copy of the state pagers and status bars care about, kept in a
+ * POSIX shared memory segment so that local programs can read it
+ * without asking the X server.  The segment's name is put into our
+ * environment as AHWM_SNAPSHOT; it is /ahwm-UID-DISPLAY.
+ * 
+ * The segment is rewritten only when something in it has changed,
+ * once we have handled every queued event (see event_get()).  It is
+ * protected by a sequence lock: 'seq' is odd while we are writing.
+ * To read it, a program copies 'seq', waits for it to be even, copies
+ * out what it wants, and starts again if 'seq' is not what it was at
+ * the start.  No locks are taken, so a reader can never stall us.
+ * 
+ * After the header come 'nclients' snapshot_client structures, top
+ * of the stacking order first, then 'nfocus' CARD32 indices into that
+ * array giving the current workspace's focus order (most recent
+ * first), then the clients' names.  Everything is in native byte
+ * order.  Readers may copy the definitions below, and should check
+ * 'magic' and 'version' before trusting anything else.
+ */
+
+#define SNAPSHOT_MAGIC   0x4d574841 /* "AHWM" on little-endian machines */
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_SIZE    (1 << 20)  /* size of the whole segment */
+
+/* snapshot_header flags */
+#define SNAPSHOT_TRUNCATED 01   /* some clients didn't fit */
+
+/* snapshot_client flags, as in the control socket's "clients" */
+#define SNAPSHOT_FOCUSED      01
+#define SNAPSHOT_ICONIC       02
+#define SNAPSHOT_OMNIPRESENT  04
+#define SNAPSHOT_UNRESPONSIVE 010
+
+typedef struct _snapshot_header {
+    CARD32 magic;
+    CARD32 version;
+    CARD32 seq;                 /* odd while being written */
+    CARD32 size;                /* bytes in use, including this */
+    CARD32 flags;
+    CARD32 workspace;           /* current workspace, from 1 */
+    CARD32 nworkspaces;
+    CARD32 focused;             /* focused window or None */
+    CARD32 nclients;
+    CARD32 nfocus;
+} snapshot_header;
+
+typedef struct _snapshot_client {
+    CARD32 window;              /* the client's window, not the frame */
+    INT32 x, y;                 /* frame geometry */
+    INT32 width, height;
+    CARD32 workspace;
+    CARD32 flags;
+    CARD32 name;                /* offset of NUL-terminated name */
+} snapshot_client;
+
+/*
+ * Create the segment.  Depends on focus_init().
+ */
+
+void snapshot_init();
+
+/*
+ * Bring the segment up to date if anything changed.  Called by the
+ * event loop before it goes to sleep.
+ */
+
+void snapshot_commit();
+
+#endif /* SNAPSHOT_H */
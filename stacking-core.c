@@ -0,0 +1,283 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+
+#include "client.h"
+#include "stacking-core.h"
+#include "malloc.h"
+#include "debug.h"
+
+static Bool grow(stack *s);
+static void raise_tree(stack *s, client_t *node, client_t *ignore,
+                       Bool go_up, stack_visit_fn visit);
+
+/* easy way to maintain invariants */
+static void set(stack *s, client_t *client, int index)
+{
+    s->clients[index] = client;
+    client->stacking_order = index;
+}
+
+/* defines partial ordering on clients
+ * returns 1 if client1 should be on top of client2
+ * returns 0 if can't determine which should be on top
+ * returns -1 if client1 should be below client2 */
+int stack_order(client_t *client1, client_t *client2)
+{
+    if (client1->always_on_top) {
+        if (client2->always_on_top)
+            return 0;
+        return 1;
+    } else if (client1->always_on_bottom) {
+        if (client2->always_on_bottom)
+            return 0;
+        return -1;
+    } else {
+        if (client2->always_on_top)
+            return -1;
+        else if (client2->always_on_bottom)
+            return 1;
+        else
+            return 0;
+    }
+}
+
+/*
+ * The new client goes just under the lowest client which must be on
+ * top of it, which puts it on top of its peers.
+ */
+
+Bool stack_add(stack *s, client_t *client)
+{
+    int i, j;
+
+    if (grow(s) == False) {
+        client->stacking_order = -1;
+        return False;
+    }
+    for (i = 0; i < s->nused; i++) {
+        if (stack_order(s->clients[i], client) > 0)
+            break;
+    }
+    for (j = s->nused; j > i; j--) {
+        set(s, s->clients[j - 1], j);
+    }
+    set(s, client, i);
+    s->nused++;
+    return True;
+}
+
+/*
+ * simply move the client on top of all other clients
+ * and decrement the number of elements in the arrays
+ */
+
+void stack_remove(stack *s, client_t *client)
+{
+    int i;
+
+    if (client->stacking_order == -1) return;
+    for (i = client->stacking_order + 1; i < s->nused; i++) {
+        debug(("Moving %d (%s) to %d (%s), nused = %d\n",
+               i, s->clients[i]->name, i - 1, s->clients[i - 1]->name,
+               s->nused));
+        set(s, s->clients[i], i - 1);
+    }
+    client->stacking_order = -1;
+    s->nused--;
+}
+
+/*
+ * Ensures array has room enough for one more member.  Returns True
+ * if have enough room.  Does not touch "nused".
+ */
+
+static Bool grow(stack *s)
+{
+    client_t **tmp;
+    int n;
+
+    if (s->nused < s->nallocated) return True;
+    n = s->nallocated == 0 ? 1 : s->nallocated * 2;
+    tmp = Realloc(s->clients, sizeof(client_t *) * n);
+    if (tmp == NULL) return False;
+    s->clients = tmp;
+    s->nallocated = n;
+    return True;
+}
+
+/*
+ * Ensures client is in correct place in array
+ * Additionally moves client to top of peers if MOVE_UP is true
+ */
+
+void stack_restack(stack *s, client_t *client, Bool move_up)
+{
+    int i;
+    client_t *ctmp;
+    int c;
+
+    i = client->stacking_order;
+
+    if (i < 0) {
+        return;
+    }
+    /* I want a bug report if you see either of these */
+    if (i > s->nused - 1) {
+        fprintf(stderr, "AHWM: restack: assertion failed: i=%d, nused=%d\n",
+                i, s->nused);
+        fprintf(stderr, "name = %s\n", client->name);
+        return;
+    }
+    if (client != s->clients[i]) {
+        fprintf(stderr,
+                "AHWM: restack: assertion failed: clients != clients[i]\n");
+    }
+
+    if (move_up) c = 0;
+    else c = 1;
+
+    /* move up if absolutely needed -OR-
+     * if possible to move up and "move_up" = True */
+    while (i + 1 < s->nused
+           && stack_order(s->clients[i], s->clients[i + 1]) >= c) {
+        /* swap client[i] and client[i + 1] */
+        ctmp = s->clients[i];
+        set(s, s->clients[i + 1], i);
+        set(s, ctmp, i + 1);
+        i++;
+    }
+
+    i = client->stacking_order;
+    
+    /* move down if absolutely needed */
+    while (i > 0 && stack_order(s->clients[i], s->clients[i - 1]) < 0) {
+        /* swap client[i] and client[i - 1] */
+        ctmp = s->clients[i];
+        set(s, s->clients[i - 1], i);
+        set(s, ctmp, i - 1);
+        i--;
+    }
+}
+
+void stack_raise_tree(stack *s, client_t *client, stack_visit_fn visit)
+{
+    raise_tree(s, client, NULL, True, visit);
+}
+
+/*
+ * Raising a window presents a somewhat interesting problem if we want
+ * to hold the following invariant:
+ * 
+ * A client's transient windows are always on top of the client.
+ *
+ * This calls for a subtle combination of mathematics and extreme violence.
+ * 
+ * Consider the following tree, with the root node being 'A', and the
+ * node we want raised being 'D' (with 'B' and 'C' being the path from
+ * the requested window to the root window):
+ * 
+ * A
+ * |- 1
+ * |  `- 2
+ * |- B
+ * |  |- 10
+ * |  |- C
+ * |  |  |- 14
+ * |  |  |- D
+ * |  |  |  |- 16
+ * |  |  |  |  `- 17
+ * |  |  |  `- 18
+ * |  |  `- 15
+ * |  `- 11
+ * |     |- 12
+ * |     `- 13
+ * `- 3
+ *    |- 4
+ *    |  `- 5
+ *    |     |- 6
+ *    |     `- 7
+ *    `- 8
+ *       `- 9
+ * 
+ * The nodes will be raised in the following order:
+ * A 1 2 3 4 5 6 7 8 9 B 10 11 12 13 C 14 15 D 16 17 18
+ * This holds the invariant, and ensures that each of A, B, C, D is
+ * raised among its siblings.
+ * 
+ * The algorithm goes as follows:
+ * 
+ * raise(D) =
+ * 
+ * go up to C, ignoring D
+ *     go up to B, ignoring C
+ *         go up to A, ignoring B
+ *             can't go any further up
+ *             raise A
+ *             raise all subtrees of A except B
+ *         raise B
+ *         raise all subtrees of B except C
+ *     raise C
+ *     raise all subtrees of C except D
+ * raise D
+ * raise all subtrees of D
+ * 
+ */
+
+static void raise_tree(stack *s, client_t *node, client_t *ignore,
+                       Bool go_up, stack_visit_fn visit)
+{
+    client_t *parent, *c;
+
+    if (node->transient_for == None) {
+        parent = NULL;
+    } else {
+        parent = client_find(node->transient_for);
+    }
+    
+    /* go up if needed */
+    if (go_up && parent != NULL && parent->keep_transients_on_top) {
+        raise_tree(s, parent, node, True, visit);
+    }
+
+    /* visit node */
+    if (visit != NULL) visit(node);
+    if (parent == NULL || stack_order(node, parent) >= 0) {
+        stack_restack(s, node, True);
+        debug(("\tRaising client %s\n", client_dbg(node)));
+    }
+
+    if (node->keep_transients_on_top == 0)
+        return;
+    
+    /* go down */
+    for (c = node->transients; c != NULL; c = c->next_transient) {
+        if (c != ignore)
+            raise_tree(s, c, NULL, False, visit);
+    }
+}
@@ -0,0 +1,85 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The stacking order as a plain array of clients, and the rules for
+ * keeping it in order (see stacking.h).  Nothing here talks to the X
+ * server, so the algorithms can be run and timed without one;
+ * stacking.c passes the result on to the server and to EWMH.
+ */
+
+#ifndef STACKING_CORE_H
+#define STACKING_CORE_H
+
+#include "config.h"
+
+#include "client.h"
+
+/*
+ * client->stacking_order is an index into "clients".  If it is -1,
+ * the client is not in the array.
+ */
+
+typedef struct _stack {
+    client_t **clients;         /* bottom-most first */
+    int nused;
+    int nallocated;
+} stack;
+
+/* called for every client a raise touches */
+typedef void (*stack_visit_fn)(client_t *client);
+
+/*
+ * Partial ordering on clients.  Returns 1 if CLIENT1 should be on top
+ * of CLIENT2, -1 if it should be below and 0 if either will do.
+ */
+
+int stack_order(client_t *client1, client_t *client2);
+
+/*
+ * Add CLIENT on top of its peers.  Returns False if out of memory, in
+ * which case CLIENT is not added.
+ */
+
+Bool stack_add(stack *s, client_t *client);
+
+void stack_remove(stack *s, client_t *client);
+
+/*
+ * Move CLIENT to where stack_order() says it must be, and to the top
+ * of its peers if MOVE_UP is True.
+ */
+
+void stack_restack(stack *s, client_t *client, Bool move_up);
+
+/*
+ * Raise CLIENT along with its transient windows and the windows it is
+ * transient for (see stacking.c), calling VISIT, if not NULL, on each
+ * of them.  Looks up transient parents with client_find().
+ */
+
+void stack_raise_tree(stack *s, client_t *client, stack_visit_fn visit);
+
+#endif /* STACKING_CORE_H */
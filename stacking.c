@@ -30,31 +30,27 @@
 
 #include "client.h"
 #include "stacking.h"
+#include "stacking-core.h"
 #include "malloc.h"
 #include "workspace.h"
 #include "debug.h"
 #include "ewmh.h"
+#include "flight.h"
+#include "trace.h"
 
 /*
- * We use parallel arrays to keep track of the stacking order.  I
- * tried to do this with linked lists, but I was not happy with the
- * performance - we have to convert to arrays of windows anyway to use
- * XRestackWindows and ewmh requires arrays of windows.  In addition,
- * the list implementation was very ugly and this is more elegant IMHO.
+ * The order itself is kept by stacking-core.c in "stacking.clients",
+ * bottom-most client first.  Here we keep two more arrays, which are
+ * refilled from it whenever the order is committed:
  * 
  * "frames" contains the frame windows, which we use for XRestackWindows()
  * 
- * "clients" contains the client structures, which we need to manage.
- *
  * "windows" contains the client windows, which are needed for EWMH.
  * 
- * "windows" and "frames" always contain two more items than "clients"
- * - we have the desktop window and the hiding window, which may not
- * be clients (and are kept respectively on top or bottom of all
- * clients).  "nused" indicates the size of the "clients" array.
- * 
- * client->stacking_order is an index into the "clients" array.
- * If client->stacking_order == -1, client is not in arrays.
+ * "windows" and "frames" always have room for two more items than
+ * there are clients - we have the desktop window and the hiding
+ * window, which may not be clients (and are kept respectively on top
+ * or bottom of all clients).
  * 
  * An additional problem arises in that XRestackWindows wants windows
  * in top-to-bottom order and EWMH wants windows in bottom-to-top
@@ -65,7 +61,7 @@
  * array is actually not parallel with "clients" and "windows" but
  * is maintained in backwards order.
  * 
- * invariants:
+ * With nused = stacking.nused:
  * 
  * top-most client is:
  * clients[nused - 1]
@@ -81,94 +77,42 @@
  * clients[i]->frame == frames[nused - i]
  */
 
+static stack stacking = { NULL, 0, 0 };
 static Window *frames = NULL;
-static client_t **clients = NULL;
 static Window *windows = NULL;
-
-static int nused = 0;
+static int nwindows = 0;        /* room in "frames" and "windows" */
 
 Window stacking_hiding_window = None;
 Window stacking_desktop_window = None;
 Window stacking_desktop_frame = None;
 
 static Bool grow();
-static int order(client_t *client1, client_t *client2);
-static void restack(client_t *client, Bool move_up);
 static void commit();
-static void raise_tree(client_t *client, client_t *ignore, Bool go_up);
+static void map_frame(client_t *client);
 
 static void dump(); /* defined out to get rid of warning */
 
-/* easy way to maintain invariants */
-static void set(client_t *client, int index)
-{
-    clients[index] = client;
-    clients[index]->stacking_order = index;
-    windows[index + 1] = client->window;
-    frames[nused - index] = client->frame;
-}
-
 void stacking_add(client_t *client)
 {
-    int i;
-    
-    if (grow() == False) {
+    if (stack_add(&stacking, client) == False || grow() == False) {
         perror("AHWM: stacking_add: grow");
-        client->stacking_order = -1;
-    }
-
-    /* add to backwards "frames" array */
-    for (i = 0; i < nused; i++) {
-        if (order(clients[i], client) > 0)
-            break;
-        frames[nused - i + 1] = frames[nused - i];
-    }
-    frames[nused - i + 1] = client->frame;
-    
-    /* add to "clients" and "windows" */
-    for (i = nused - 1; i >= 0; i--) {
-        if (order(clients[i], client) == 0)
-            break;
-        clients[i + 1] = clients[i];
-        clients[i + 1]->stacking_order = i + 1;
-        windows[i + 2] = windows[i + 2];
+        stack_remove(&stacking, client);
+        return;
     }
-    clients[i + 1] = client;
-    clients[i + 1]->stacking_order = i + 1;
-
-    nused++;
     commit();
 }
 
-/*
- * simply move the client on top of all other clients
- * and decrement the number of elements in the arrays
- */
-
 void stacking_remove(client_t *client)
 {
-    int i;
-
-	if (client->stacking_order == -1) return;
-    for (i = client->stacking_order + 1; i < nused; i++) {
-        debug(("Moving %d (%s) to %d (%s), nused = %d\n",
-               i, clients[i]->name, i - 1, clients[i - 1]->name, nused));
-        clients[i - 1] = clients[i];
-        clients[i - 1]->stacking_order = i - 1;
-        windows[i] = windows[i + 1];
-    }
-    for (i = nused - client->stacking_order; i <= nused; i++) {
-        frames[i] = frames[i + 1];
-    }
-    client->stacking_order = -1;
-    nused--;
+    if (client->stacking_order == -1) return;
+    stack_remove(&stacking, client);
     commit();
 }
 
 client_t *stacking_top()
 {
-    if (nused == 0) return NULL;
-    else return clients[nused - 1];
+    if (stacking.nused == 0) return NULL;
+    else return stacking.clients[stacking.nused - 1];
 }
 
 /* FIXME:  remove NULL checks here, do once, further up call tree */
@@ -177,45 +121,62 @@ client_t *stacking_prev(client_t *client)
     if (client == NULL)
         return NULL;
     if (client->stacking_order <= 0) return NULL;
-    else return clients[client->stacking_order - 1];
+    else return stacking.clients[client->stacking_order - 1];
 }
 
 client_t *stacking_next(client_t *client)
 {
     if (client == NULL)
         return NULL;
-    if (client->stacking_order >= nused - 1) return NULL;
-    else return clients[client->stacking_order + 1];
+    if (client->stacking_order >= stacking.nused - 1) return NULL;
+    else return stacking.clients[client->stacking_order + 1];
+}
+
+int stacking_depth(client_t *client)
+{
+    return stacking.nused - 1 - client->stacking_order;
 }
 
 void stacking_raise(client_t *client)
 {
     if (client == NULL)
         return;
-    raise_tree(client, NULL, True);
+    stack_raise_tree(&stacking, client, map_frame);
     commit();
+    flight_log(FLIGHT_RAISE, 0, client->window, stacking_depth(client));
 }
 
 void stacking_restack(client_t *client)
 {
     if (client == NULL)
         return;
-    restack(client, False);
+    stack_restack(&stacking, client, False);
     commit();
+    flight_log(FLIGHT_RESTACK, 0, client->window, stacking_depth(client));
+}
+
+/* every window a raise touches is mapped if it should be visible */
+static void map_frame(client_t *client)
+{
+    if (client->workspace == workspace_current
+        && client->state == NormalState) {
+        XMapWindow(dpy, client->frame); /* why is this here?  does not negate perf. gain? */
+    }
 }
 
 /* defined out to get rid of warning */
 static void dump()
 {
 #ifdef DEBUG
-    int i;
+    int i, nused;
     client_t *client;
 
+    nused = stacking.nused;
     fprintf(stderr, "----\n");
     fprintf(stderr, "Clients:\n");
     for (i = 0; i < nused; i++) {
         fprintf(stderr, "% 2d. %#lx %s\n",
-                i, clients[i]->frame, clients[i]->name);
+                i, stacking.clients[i]->frame, stacking.clients[i]->name);
     }
     fprintf(stderr, "Frames:\n");
     for (i = nused; i > 0; i--) {
@@ -239,41 +200,24 @@ static void dump()
 }
 
 /*
- * Ensures arrays have room enough for one more member.  Returns True
- * if have enough room.  Does not touch "nused".
+ * Ensures "frames" and "windows" have room for every client plus the
+ * two extra windows.  Returns True if have enough room.
  */
 
 static Bool grow()
 {
-    static int nallocated = 0;
-    Window *win_tmp;
-    client_t **client_tmp;
-    Window *frame_tmp;
-    
-    if (nallocated == 0) {
-        frames = Malloc(sizeof(Window) * 3);
-        windows = Malloc(sizeof(Window) * 3);
-        clients = Malloc(sizeof(client_t *));
-        if (frames == NULL || clients == NULL || windows == NULL) {
-            if (frames != NULL) Free(frames);
-            if (clients != NULL) Free(clients);
-            if (windows != NULL) Free(windows);
-            return False;
-        }
-        nallocated = 1;
-    } else if (nallocated == nused) {
-        win_tmp = Realloc(windows, sizeof(Window) * (nallocated * 2 + 2));
-        frame_tmp = Realloc(frames, sizeof(Window) * (nallocated * 2 + 2));
-        client_tmp = Realloc(clients, sizeof(client_t *) * nallocated * 2);
-
-        if (win_tmp == NULL || client_tmp == NULL || frame_tmp == NULL) {
-            return False;
-        }
-        windows = win_tmp;
-        clients = client_tmp;
-        frames = frame_tmp;
-        nallocated *= 2;
-    }
+    Window *win_tmp, *frame_tmp;
+    int n;
+
+    if (stacking.nallocated + 2 <= nwindows) return True;
+    n = stacking.nallocated + 2;
+    win_tmp = Realloc(windows, sizeof(Window) * n);
+    if (win_tmp == NULL) return False;
+    windows = win_tmp;
+    frame_tmp = Realloc(frames, sizeof(Window) * n);
+    if (frame_tmp == NULL) return False;
+    frames = frame_tmp;
+    nwindows = n;
     return True;
 }
 
@@ -283,8 +227,12 @@ static Bool grow()
 
 static void commit()
 {
-    int start, nitems, e_start, e_nitems, i;
+    int start, nitems, e_start, e_nitems, i, nused;
 
+    nused = stacking.nused;
+    for (i = 0; i < nused; i++) {
+        frames[nused - i] = stacking.clients[i]->frame;
+    }
     nitems = nused;
     if (stacking_hiding_window != None) {
         frames[0] = stacking_hiding_window;
@@ -298,6 +246,7 @@ static void commit()
         nitems++;
     }
     XRestackWindows(dpy, &frames[start], nitems);
+    TRACE1(stacking_commit, nitems);
 
     /* we ignore stacking_hiding_window for EWMH */
     if (stacking_desktop_window != None) {
@@ -309,178 +258,8 @@ static void commit()
 		e_nitems = nitems;
     }
 	for (i = 0; i < nused; i++) {
-		windows[1 + i] = clients[i]->window;
+		windows[1 + i] = stacking.clients[i]->window;
 	}
 	ewmh_stacking_list_update(&windows[e_start], e_nitems);
 	dump();
 }
-
-/* defines partial ordering on clients
- * returns 1 if client1 should be on top of client2
- * returns 0 if can't determine which should be on top
- * returns -1 if client1 should be below client2 */
-static int order(client_t *client1, client_t *client2)
-{
-    if (client1->always_on_top) {
-        if (client2->always_on_top)
-            return 0;
-        return 1;
-    } else if (client1->always_on_bottom) {
-        if (client2->always_on_bottom)
-            return 0;
-        return -1;
-    } else {
-        if (client2->always_on_top)
-            return -1;
-        else if (client2->always_on_bottom)
-            return 1;
-        else
-            return 0;
-    }
-}
-
-/*
- * Ensures client is in correct place in arrays
- * Additionally moves client to top of peers if MOVE_UP is true
- */
-
-static void restack(client_t *client, Bool move_up)
-{
-    int i;
-    client_t *ctmp;
-    int c;
-
-    i = client->stacking_order;
-
-    if (i < 0) {
-        return;
-    }
-    /* I want a bug report if you see either of these */
-    if (i > nused - 1) {
-        fprintf(stderr, "AHWM: restack: assertion failed: i=%d, nused=%d\n",
-                i, nused);
-        fprintf(stderr, "name = %s\n", client->name);
-        return;
-    }
-    if (client != clients[i]) {
-        fprintf(stderr,
-                "AHWM: restack: assertion failed: clients != clients[i]\n");
-    }
-
-    if (move_up) c = 0;
-    else c = 1;
-
-    /* move up if absolutely needed -OR-
-     * if possible to move up and "move_up" = True */
-    while (i + 1 < nused && order(clients[i], clients[i + 1]) >= c) {
-        /* swap client[i] and client[i + 1] */
-        ctmp = clients[i];
-        set(clients[i + 1], i);
-        set(ctmp, i + 1);
-        i++;
-    }
-
-    i = client->stacking_order;
-    
-    /* move down if absolutely needed */
-    while (i > 0 && order(clients[i], clients[i - 1]) < 0) {
-        /* swap client[i] and client[i - 1] */
-        ctmp = clients[i];
-        set(clients[i - 1], i);
-        set(ctmp, i - 1);
-        i--;
-    }
-}
-
-/*
- * Raising a window presents a somewhat interesting problem if we want
- * to hold the following invariant:
- * 
- * A client's transient windows are always on top of the client.
- *
- * This calls for a subtle combination of mathematics and extreme violence.
- * 
- * Consider the following tree, with the root node being 'A', and the
- * node we want raised being 'D' (with 'B' and 'C' being the path from
- * the requested window to the root window):
- * 
- * A
- * |- 1
- * |  `- 2
- * |- B
- * |  |- 10
- * |  |- C
- * |  |  |- 14
- * |  |  |- D
- * |  |  |  |- 16
- * |  |  |  |  `- 17
- * |  |  |  `- 18
- * |  |  `- 15
- * |  `- 11
- * |     |- 12
- * |     `- 13
- * `- 3
- *    |- 4
- *    |  `- 5
- *    |     |- 6
- *    |     `- 7
- *    `- 8
- *       `- 9
- * 
- * The nodes will be raised in the following order:
- * A 1 2 3 4 5 6 7 8 9 B 10 11 12 13 C 14 15 D 16 17 18
- * This holds the invariant, and ensures that each of A, B, C, D is
- * raised among its siblings.
- * 
- * The algorithm goes as follows:
- * 
- * raise(D) =
- * 
- * go up to C, ignoring D
- *     go up to B, ignoring C
- *         go up to A, ignoring B
- *             can't go any further up
- *             raise A
- *             raise all subtrees of A except B
- *         raise B
- *         raise all subtrees of B except C
- *     raise C
- *     raise all subtrees of C except D
- * raise D
- * raise all subtrees of D
- * 
- */
-
-static void raise_tree(client_t *node, client_t *ignore, Bool go_up)
-{
-    client_t *parent, *c;
-
-    if (node->transient_for == None) {
-        parent = NULL;
-    } else {
-        parent = client_find(node->transient_for);
-    }
-    
-    /* go up if needed */
-    if (go_up && parent != NULL && parent->keep_transients_on_top) {
-        raise_tree(parent, node, True);
-    }
-
-    /* visit node */
-    if (node->workspace == workspace_current && node->state == NormalState) {
-        XMapWindow(dpy, node->frame); /* why is this here?  does not negate perf. gain? */
-    }
-    if (parent == NULL || order(node, parent) >= 0) {
-        restack(node, True);
-        debug(("\tRaising client %s\n", client_dbg(node)));
-    }
-
-    if (node->keep_transients_on_top == 0)
-        return;
-    
-    /* go down */
-    for (c = node->transients; c != NULL; c = c->next_transient) {
-        if (c != ignore)
-            raise_tree(c, NULL, False);
-    }
-}
@@ -83,6 +83,12 @@ client_t *stacking_top();
 client_t *stacking_prev(client_t *client);
 client_t *stacking_next(client_t *client);
 
+/*
+ * Returns how many clients are on top of the given client
+ */
+
+int stacking_depth(client_t *client);
+
 /*
  * This will:
  * 
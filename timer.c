@@ -24,52 +24,73 @@
  */
 /*
  * This stuff is speed-critical, so we pull all the stops.  The
- * latency associated with a gettimeofday() system call is killer, so
- * we avoid those like a bad clich.  We keep the timers sorted using
- * a heap.  This is the only place where we use a heap, so we don't
- * abstract out the priority queue data type.
+ * latency associated with a system call to read the clock is killer,
+ * so we avoid those like a bad clich.  We keep the timers sorted
+ * using a heap.  This is the only place where we use a heap, so we
+ * don't abstract out the priority queue data type.
+ * 
+ * Timer objects are carved out of slabs and kept on a free list when
+ * cancelled, so that callers who create and cancel timers all the
+ * time (animations, raise delays) don't hit malloc().  Each timer
+ * remembers its position in the heap, so removing or rescheduling any
+ * timer is O(log n).
  */
 
+#include "config.h"
+
 #include "timer.h"
+#include "trace.h"
 
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 /* we use a standard heap */
-#define RCHILD(i) (2*(i)+1)
-#define LCHILD(i) (2*(i)+2)
+#define LCHILD(i) (2*(i)+1)
+#define RCHILD(i) (2*(i)+2)
 #define PARENT(i) (((i)-1)/2)
 
+/* number of timers to allocate at once when the pool runs dry */
+#define TIMER_SLAB 32
+
 struct _timer {
-    enum { DONE, ACTIVE } state;
+    enum { DONE, ACTIVE, FREE } state;
     int index;
     struct timeval tv;
+    int period;                 /* milliseconds; zero if not periodic */
     timer_fn fn;
     void *arg;
+    struct _timer *next_free;
 };
 
 static timer **timers;
 
 static int nused, nallocated;
 
-static int timeval_compare(struct timeval *tv1, struct timeval *tv2);
-static void timeval_normalize(struct timeval *tv);
+static timer *free_timers = NULL;
+
+static timer *timer_alloc();
+static int timeval_before(struct timeval *tv1, struct timeval *tv2);
+static void timeval_add_msecs(struct timeval *tv, int msecs);
 static void timer_run_with_tv(struct timeval *now);
+static int insert_timer(timer *t);
 static void remove_timer(timer *t);
+static void sift_up(int i);
+static void sift_down(int i);
 
 void timer_init()
 {
     /* start out with eight timers */
-    timers = malloc(sizeof(timer *) * 1);
+    timers = malloc(sizeof(timer *) * 8);
     if (timers == NULL) {
         perror("malloc");
         exit(1);
     }
-    nallocated = 1;
+    nallocated = 8;
 }
 
 int timer_pending(timer *t)
@@ -77,144 +98,229 @@ int timer_pending(timer *t)
     return t->state == ACTIVE ? 1 : 0;
 }
 
+void timer_now(struct timeval *tv)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        tv->tv_sec = ts.tv_sec;
+        tv->tv_usec = ts.tv_nsec / 1000;
+        return;
+    }
+#endif
+    gettimeofday(tv, NULL);
+}
+
 timer *timer_new(int msecs, timer_fn fn, void *arg)
 {
-    timer *t, *tmp, **tmp2;
-    struct timeval now;
-    int i;
+    timer *t;
 
-    t = malloc(sizeof(timer));
+    t = timer_alloc();
     if (t == NULL) {
         return NULL;
     }
+    t->fn = fn;
+    t->arg = arg;
+    t->period = 0;
+    timer_now(&t->tv);
+    timeval_add_msecs(&t->tv, msecs);
+    if (insert_timer(t) == 0) {
+        timer_cancel(t);
+        return NULL;
+    }
+    return t;
+}
+
+timer *timer_new_periodic(int msecs, timer_fn fn, void *arg)
+{
+    timer *t;
+
+    t = timer_new(msecs, fn, arg);
+    if (t != NULL) {
+        t->period = msecs > 0 ? msecs : 1;
+    }
+    return t;
+}
+
+void timer_rearm(timer *t, int msecs)
+{
+    timer_now(&t->tv);
+    timeval_add_msecs(&t->tv, msecs);
+    if (t->state != ACTIVE) {
+        /* can only fail if the heap needs to grow */
+        if (insert_timer(t) == 0) {
+            perror("AHWM: timer_rearm");
+        }
+        return;
+    }
+    /* already in the heap, just move it */
+    sift_up(t->index);
+    sift_down(t->index);
+}
+
+void timer_disarm(timer *t)
+{
+    remove_timer(t);
+}
+
+void timer_cancel(timer *t)
+{
+    remove_timer(t);
+    t->state = FREE;
+    t->next_free = free_timers;
+    free_timers = t;
+}
+
+/*
+ * Get a timer from the free list, refilling the free list a slab at a
+ * time.  Slabs are never given back.
+ */
+
+static timer *timer_alloc()
+{
+    timer *t, *slab;
+    int i;
+
+    if (free_timers == NULL) {
+        slab = malloc(sizeof(timer) * TIMER_SLAB);
+        if (slab == NULL) {
+            return NULL;
+        }
+        for (i = 0; i < TIMER_SLAB; i++) {
+            slab[i].state = FREE;
+            slab[i].next_free = free_timers;
+            free_timers = &slab[i];
+        }
+    }
+    t = free_timers;
+    free_timers = t->next_free;
+    t->state = DONE;
+    t->next_free = NULL;
+    return t;
+}
+
+/*
+ * Put a timer into the heap.  Returns zero if the heap needed to grow
+ * and we couldn't make it.
+ */
+
+static int insert_timer(timer *t)
+{
+    timer **tmp;
+
     /* enlarge array if needed (we never shrink it again) */
     if (nused == nallocated) {
-        tmp2 = realloc(timers, sizeof(timer *) * nallocated * 2);
-        if (tmp2 == NULL) {
-            free(t);
-            return NULL;
+        tmp = realloc(timers, sizeof(timer *) * nallocated * 2);
+        if (tmp == NULL) {
+            return 0;
         }
-        timers = tmp2;
+        timers = tmp;
         nallocated *= 2;
     }
 
-    gettimeofday(&now, NULL);
+    /* put element in last position of complete tree and sift up */
     t->state = ACTIVE;
-    t->fn = fn;
-    t->arg = arg;
-    t->tv.tv_sec = now.tv_sec;
-    t->tv.tv_usec = now.tv_usec + msecs * 1000;
-    timeval_normalize(&t->tv);
-
-    /* put element in last position of complete tree */
     timers[nused] = t;
     t->index = nused++;
-
-    /* if this is the only element, it's in correct position */
-    if (nused == 1) {
-        return t;
-    }
-    
-    /* sift up */
-    i = nused - 1;
-    while (timeval_compare(&timers[PARENT(i)]->tv, &timers[i]->tv) < 0) {
-        /* swap */
-        tmp = timers[i];
-        timers[i] = timers[PARENT(i)];
-        timers[PARENT(i)] = tmp;
-        timers[i]->index = i;
-        timers[PARENT(i)]->index = PARENT(i);
-
-        i = PARENT(i);
-    }
-    return t;
+    sift_up(t->index);
+    return 1;
 }
 
 /*
  * Remove an element of the heap, not necessarily the top one.
  * 
- * Swapping with the last element and sifting down works with all
- * elements of the heap, not only the top one.
+ * We move the last element into the hole; it may need to go either
+ * up or down from there, depending on where the hole was.
  */
 
 static void remove_timer(timer *t)
 {
-    int i, smallest;
-    timer *tmp;
+    int i;
 
-    if (t->state == DONE) {
+    if (t->state != ACTIVE) {
         return;
     }
     i = t->index;
     t->state = DONE;
-    tmp = t;
-    timers[i] = timers[nused - 1];
-    timers[nused - 1] = tmp;
-    timers[i]->index = i;
-    timers[nused - 1]->index = nused - 1;
     nused--;
+    if (i == nused) {
+        return;
+    }
+    timers[i] = timers[nused];
+    timers[i]->index = i;
+    sift_up(i);
+    sift_down(i);
+}
+
+static void sift_up(int i)
+{
+    timer *tmp;
+
+    while (i > 0 && timeval_before(&timers[i]->tv, &timers[PARENT(i)]->tv)) {
+        tmp = timers[i];
+        timers[i] = timers[PARENT(i)];
+        timers[PARENT(i)] = tmp;
+        timers[i]->index = i;
+        timers[PARENT(i)]->index = PARENT(i);
+
+        i = PARENT(i);
+    }
+}
+
+static void sift_down(int i)
+{
+    int smallest;
+    timer *tmp;
 
     for (;;) {
-        /* find the smallest child */
+        /* find the earliest child */
         smallest = LCHILD(i);
         if (smallest >= nused) {
             break;
         }
         if (RCHILD(i) < nused &&
-            timeval_compare(&timers[RCHILD(i)]->tv,
-                            &timers[smallest]->tv) > 0) {
+            timeval_before(&timers[RCHILD(i)]->tv, &timers[smallest]->tv)) {
             smallest = RCHILD(i);
         }
-        /* sift down if needed */
-        if (timeval_compare(&timers[i]->tv, &timers[smallest]->tv) < 0) {
-            tmp = timers[i];
-            timers[i] = timers[smallest];
-            timers[smallest] = tmp;
-            timers[i]->index = i;
-            timers[smallest]->index = smallest;
-            
-            i = smallest;
-        } else {
+        if (!timeval_before(&timers[smallest]->tv, &timers[i]->tv)) {
             break;
         }
+        tmp = timers[i];
+        timers[i] = timers[smallest];
+        timers[smallest] = tmp;
+        timers[i]->index = i;
+        timers[smallest]->index = smallest;
+
+        i = smallest;
     }
 }
 
-/* assumes both members are positive */
-static void timeval_normalize(struct timeval *tv)
+/* assumes MSECS is positive */
+static void timeval_add_msecs(struct timeval *tv, int msecs)
 {
-    while (tv->tv_usec > 1000000) {
+    tv->tv_sec += msecs / 1000;
+    tv->tv_usec += (msecs % 1000) * 1000;
+    if (tv->tv_usec >= 1000000) {
         tv->tv_sec++;
         tv->tv_usec -= 1000000;
     }
 }
 
-/* -1: tv1 later; 0: tv1 = tv2; 1: tv2 later */
-/* assumes both args have been "normalized" */
-static int timeval_compare(struct timeval *tv1, struct timeval *tv2)
+/* is tv1 strictly earlier than tv2? */
+static int timeval_before(struct timeval *tv1, struct timeval *tv2)
 {
     if (tv1->tv_sec == tv2->tv_sec) {
-        if (tv1->tv_usec > tv2->tv_usec) {
-            return -1;
-        } else {
-            return tv1->tv_usec == tv2->tv_usec ? 0 : 1;
-        }
-    } else {
-        return tv1->tv_sec > tv2->tv_sec ? -1 : 1;
+        return tv1->tv_usec < tv2->tv_usec;
     }
-}
-
-void timer_cancel(timer *t)
-{
-    remove_timer(t);
-    free(t);
+    return tv1->tv_sec < tv2->tv_sec;
 }
 
 int timer_next_time(struct timeval *tv)
 {
     struct timeval now, next;
     
-    gettimeofday(&now, NULL);
+    timer_now(&now);
     timer_run_with_tv(&now);
 
     if (nused == 0) {
@@ -230,11 +336,21 @@ int timer_next_time(struct timeval *tv)
     return 1;
 }
 
+int timer_next_deadline(struct timeval *tv)
+{
+    timer_run();
+    if (nused == 0) {
+        return 0;
+    }
+    *tv = timers[0]->tv;
+    return 1;
+}
+
 void timer_run()
 {
     struct timeval now;
     
-    gettimeofday(&now, NULL);
+    timer_now(&now);
     timer_run_with_tv(&now);
 }
 
@@ -252,11 +368,23 @@ static void timer_run_with_tv(struct timeval *now)
 {
     timer *t;
     
-    while (nused > 0 && timeval_compare(now, &timers[0]->tv) <= 0) {
+    while (nused > 0 && !timeval_before(now, &timers[0]->tv)) {
         /* must remove before calling user function - user function
-         * might call timer_cancel, which calls free() */
+         * might call timer_cancel, which recycles the timer.  Periodic
+         * timers are put back first, so the user function may also
+         * cancel, disarm or rearm them. */
         t = timers[0];
         remove_timer(t);
+        if (t->period > 0) {
+            timeval_add_msecs(&t->tv, t->period);
+            if (!timeval_before(now, &t->tv)) {
+                /* fell behind; drop the missed shots */
+                t->tv = *now;
+                timeval_add_msecs(&t->tv, t->period);
+            }
+            insert_timer(t);
+        }
+        TRACE2(timer_fire, t, t->fn);
         (t->fn)(t, t->arg);
     }
 }
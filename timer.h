@@ -30,6 +30,11 @@
  * Provides fine-grained timers.  This allows you to say "call this
  * function in fifty milliseconds."  Needs to be integrated with your
  * main event loop.
+ *
+ * Times are measured with the monotonic clock where available, so
+ * setting the system time does not make timers fire early or late.
+ * Timer objects come from a pool and are recycled, so creating and
+ * cancelling timers does not call malloc() once the pool is warm.
  */
 
 #include <sys/types.h>
@@ -60,15 +65,37 @@ void timer_init();
 /*
  * Create a new timer.  FN will be called with ARG in MSECS
  * milliseconds.  Resolution depends on how often timer_run() is
- * called.  Returns opaque type; can't do much with the return value
- * except timer_cancel().  Timers are not recurring (eg, call
- * timer_new in your function if you want it to be called again,
- * module will deal with this efficiently).  Returns NULL if out of
- * memory.
+ * called.  Returns opaque type; pass it to timer_cancel() when you
+ * are done with it, or use timer_rearm() to make it shoot again
+ * without creating a new timer.  Returns NULL if out of memory.
  */
 
 timer *timer_new(int msecs, timer_fn fn, void *arg);
 
+/*
+ * Like timer_new(), but the timer shoots every MSECS milliseconds
+ * until it is cancelled or disarmed.  If we fall behind, missed
+ * shots are dropped rather than delivered in a burst.
+ */
+
+timer *timer_new_periodic(int msecs, timer_fn fn, void *arg);
+
+/*
+ * Make a timer shoot MSECS milliseconds from now, whether or not it
+ * is currently pending.  A periodic timer keeps its period.  This is
+ * O(log n) and never allocates.
+ */
+
+void timer_rearm(timer *t, int msecs);
+
+/*
+ * Stop a timer from shooting without deleting it; it may be used
+ * again with timer_rearm().  Does nothing if the timer is not
+ * pending.  O(log n).
+ */
+
+void timer_disarm(timer *t);
+
 /*
  * Cancel and delete a timer before it shoots, or simply delete a
  * timer that's already shot.  All timers created with timer_new must
@@ -84,6 +111,13 @@ void timer_cancel(timer *t);
 
 int timer_pending(timer *t);
 
+/*
+ * Get the current time from the same clock the timers use.  Only
+ * useful for measuring intervals.
+ */
+
+void timer_now(struct timeval *tv);
+
 /*
  * Copy into TV the next time a timer will shoot.  The value placed
  * into TV is suitable for use with select(2).  Returns 1 if copied in
@@ -94,6 +128,14 @@ int timer_pending(timer *t);
 
 int timer_next_time(struct timeval *tv);
 
+/*
+ * Like timer_next_time(), but places into TV the absolute time (as
+ * measured by timer_now()) at which the next timer will shoot.  Runs
+ * any timers which are already due.
+ */
+
+int timer_next_deadline(struct timeval *tv);
+
 /*
  * Run timers
  */
@@ -101,7 +143,7 @@ int timer_next_time(struct timeval *tv);
 void timer_run();
 
 /*
- * Like timer_run(), but avoids calling gettimeofday(); this is meant
+ * Like timer_run(), but avoids reading the clock; this is meant
  * to be called after select() times out with a period returned from
  * timer_next_time().  This assumes the current time is equal to what
  * timer_next_time uses.
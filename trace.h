@@ -0,0 +1,71 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "config.h"
+
+/*
+ * Static tracepoints for perf, bpftrace, SystemTap and friends, so
+ * that a slow handler or a misbehaving window can be found on a
+ * running system without a DEBUG build.  Where <sys/sdt.h> exists
+ * each probe is a single no-op instruction plus a note in the binary
+ * telling the tracer where it is and where its arguments live; the
+ * arguments are only computed into registers, never formatted.
+ * Elsewhere the probes compile to nothing, so arguments must not
+ * have side effects.
+ * 
+ * The provider is "ahwm"; e.g. bpftrace -l 'usdt:/usr/bin/ahwm:*'
+ * 
+ * event_start, event_end    event type, window (see event_window())
+ * focus_change              old client window, new client window
+ *                           (or None), timestamp
+ * stacking_commit           number of frames restacked
+ * prefs_apply               client window
+ * place                     client window, x, y
+ * workspace_goto            old workspace, new workspace
+ * client_create             client window
+ * client_destroy            client window
+ * timer_fire                timer, callback function
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define TRACE1(name, a) DTRACE_PROBE1(ahwm, name, a)
+#define TRACE2(name, a, b) DTRACE_PROBE2(ahwm, name, a, b)
+#define TRACE3(name, a, b, c) DTRACE_PROBE3(ahwm, name, a, b, c)
+
+#else
+
+#define TRACE1(name, a) /* */
+#define TRACE2(name, a, b) /* */
+#define TRACE3(name, a, b, c) /* */
+
+#endif /* HAVE_SYS_SDT_H */
+
+#endif /* TRACE_H */
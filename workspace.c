@@ -35,6 +35,7 @@
 #include "ewmh.h"
 #include "stacking.h"
 #include "xev.h"
+#include "trace.h"
 
 unsigned int nworkspaces = 1;
 unsigned int workspace_current = 1;
@@ -82,6 +83,7 @@ void workspace_goto(unsigned int new_workspace)
     }
 
     debug(("\tGoing to workspace %d\n", new_workspace));
+    TRACE2(workspace_goto, workspace_current, new_workspace);
 
     /* When we unmap the windows in order to change workspaces,
      * sometimes it is possible to see the actual unmappings as
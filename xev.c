@@ -609,6 +609,26 @@ do_MappingNotify (eventp)
     XRefreshKeyboardMapping(e);
 }
 
+static const char *event_names[] = {
+    "Zero", "One", "KeyPress", "KeyRelease", "ButtonPress",
+    "ButtonRelease", "MotionNotify", "EnterNotify", "LeaveNotify",
+    "FocusIn", "FocusOut", "KeymapNotify", "Expose", "GraphicsExpose",
+    "NoExpose", "VisibilityNotify", "CreateNotify", "DestroyNotify",
+    "UnmapNotify", "MapNotify", "MapRequest", "ReparentNotify",
+    "ConfigureNotify", "ConfigureRequest", "GravityNotify",
+    "ResizeRequest", "CirculateNotify", "CirculateRequest",
+    "PropertyNotify", "SelectionClear", "SelectionRequest",
+    "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify",
+};
+
+const char *xev_name(int type)
+{
+    if (type < 0 || type > MappingNotify)
+        return NULL;
+    return event_names[type];
+}
+
 void xev_print(XEvent *event)
 {
 	switch (event->type) {
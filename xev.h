@@ -31,4 +31,10 @@
 
 void xev_print(XEvent *);
 
+/*
+ * The name of core event TYPE, or NULL if it is an extension event.
+ */
+
+const char *xev_name(int type);
+
 #endif /* XEV_H */
@@ -0,0 +1,158 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+#include <stdio.h>
+
+#include "ahwm.h"
+#include "xstats.h"
+#include "xev.h"
+#include "debug.h"
+#include "compat.h"
+
+/* event types are seven bits; slot 0 is "other" */
+#define XSTATS_TYPES 128
+
+typedef struct _xstats_counts {
+    unsigned long events;
+    unsigned long requests;
+    unsigned long roundtrips;
+    unsigned long worst;        /* most round trips by one handler */
+    unsigned long over;         /* handlers over budget */
+} xstats_counts;
+
+int xstats_budget = 0;
+
+static xstats_counts counts[XSTATS_TYPES];
+static Bool counting = False;
+static int current = 0;         /* type being handled */
+static unsigned long roundtrips = 0; /* by the current handler */
+static unsigned long last_next = 0;
+static unsigned long last_read = 0;
+
+static int after_function(Display *display);
+
+void xstats_init()
+{
+    if (xstats_budget <= 0) return;
+    last_next = NextRequest(dpy);
+    last_read = LastKnownRequestProcessed(dpy);
+    XSetAfterFunction(dpy, after_function);
+    counting = True;
+}
+
+/* called by Xlib at the end of every Xlib call */
+static int after_function(Display *display)
+{
+    unsigned long next, read;
+
+    next = NextRequest(display);
+    read = LastKnownRequestProcessed(display);
+    counts[current].requests += next - last_next;
+    last_next = next;
+    if (read != last_read) {
+        if (read == next - 1) {
+            counts[current].roundtrips++;
+            roundtrips++;
+        }
+        last_read = read;
+    }
+    return 0;
+}
+
+void xstats_enter(xstats_frame *frame, int type)
+{
+    if (!counting) return;
+    if (type < 0 || type >= XSTATS_TYPES) type = 0;
+    frame->type = current;
+    frame->roundtrips = roundtrips;
+    current = type;
+    roundtrips = 0;
+    counts[type].events++;
+}
+
+void xstats_leave(xstats_frame *frame)
+{
+    xstats_counts *c;
+    const char *name;
+
+    if (!counting) return;
+    c = &counts[current];
+    if (roundtrips > c->worst) c->worst = roundtrips;
+    if (roundtrips > (unsigned long)xstats_budget) {
+        if (c->over++ == 0) {
+            name = xev_name(current);
+            if (name != NULL)
+                fprintf(stderr, "AHWM: %s handler waited for %lu replies "
+                        "(RoundTripBudget is %d)\n",
+                        name, roundtrips, xstats_budget);
+            else
+                fprintf(stderr, "AHWM: handler for event %d waited for "
+                        "%lu replies (RoundTripBudget is %d)\n",
+                        current, roundtrips, xstats_budget);
+        }
+    }
+    current = frame->type;
+    roundtrips = frame->roundtrips;
+}
+
+void xstats_report(report_fn out)
+{
+    xstats_counts *c;
+    const char *name;
+    char buf[16];
+    int i;
+
+    if (!counting) return;
+    out("xstats: %-17s %8s %9s %8s %5s %5s\n", "handler", "events",
+        "requests", "replies", "worst", "over");
+    for (i = 0; i < XSTATS_TYPES; i++) {
+        c = &counts[i];
+        if (c->events == 0 && c->requests == 0) continue;
+        if (i == 0) {
+            name = "other";
+        } else if ((name = xev_name(i)) == NULL) {
+            snprintf(buf, sizeof(buf), "event %d", i);
+            name = buf;
+        }
+        out("xstats: %-17s %8lu %9lu %8lu %5lu %5lu\n", name, c->events,
+            c->requests, c->roundtrips, c->worst, c->over);
+    }
+}
+
+Bool xstats_totals(unsigned long *requests, unsigned long *roundtrips)
+{
+    int i;
+
+    if (!counting) return False;
+    *requests = *roundtrips = 0;
+    for (i = 1; i < XSTATS_TYPES; i++) {
+        *requests += counts[i].requests;
+        *roundtrips += counts[i].roundtrips;
+    }
+    return True;
+}
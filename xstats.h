@@ -0,0 +1,92 @@
+/* $Id$ */
+/* Copyright (c) 2001 Alex Hioreanu.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef XSTATS_H
+#define XSTATS_H
+
+#include "config.h"
+
+#include <X11/Xlib.h>
+
+#include "debug.h"
+
+/*
+ * Counts the X requests we send and the replies we wait for, charged
+ * to the kind of event being handled when they happen (nested
+ * dispatch, as in move-resize.c, is charged to the inner event), and
+ * to "other" outside any handler: timers, the control socket and
+ * start-up.  A handler which waits for more than RoundTripBudget
+ * replies is reported once per event type.
+ * 
+ * Requests are counted from the request serial numbers.  Xlib tells
+ * us nothing about replies, so we use XSetAfterFunction() to look at
+ * the connection after every Xlib call, and count a reply whenever
+ * the last request the server is known to have processed has caught
+ * up with the last one we sent.  An event read by a call which wasn't
+ * waiting for a reply can occasionally be counted as one, so the
+ * numbers are approximate, but the round trips that hurt (XSync,
+ * XGetWindowProperty, XQueryPointer and so on) are all caught.
+ */
+
+/* the RoundTripBudget option; zero turns all this off */
+extern int xstats_budget;
+
+/* state saved across a nested event handler */
+typedef struct _xstats_frame {
+    int type;
+    unsigned long roundtrips;
+} xstats_frame;
+
+/*
+ * Start counting if RoundTripBudget is set.  Depends on prefs_init().
+ */
+
+void xstats_init();
+
+/*
+ * Called by event_dispatch() around the handler for an event of the
+ * given TYPE; FRAME is somewhere on the caller's stack.
+ */
+
+void xstats_enter(xstats_frame *frame, int type);
+void xstats_leave(xstats_frame *frame);
+
+/*
+ * Write the counts per event type through OUT.
+ */
+
+void xstats_report(report_fn out);
+
+/*
+ * The requests and round trips counted since start-up by the event
+ * handlers, for ahwm-bench to compare.  "other" is left out: what
+ * timers do depends on how long things take, and the main loop's
+ * reads are where events get mistaken for replies.  False if we
+ * aren't counting.
+ */
+
+Bool xstats_totals(unsigned long *requests, unsigned long *roundtrips);
+
+#endif /* XSTATS_H */